@@ -8,6 +8,15 @@ public class GAM415_Green : ModuleRules
 	{
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 
-		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "EnhancedInput", "Niagara", "ProceduralMeshComponent" });
+		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "EnhancedInput", "Niagara", "ProceduralMeshComponent", "PhysicsCore", "Chaos" });
+
+		// Sources in subfolders (the automation tests under Tests) include the module's headers by name
+		PrivateIncludePaths.Add(ModuleDirectory);
+
+		// The terrain bake commandlet writes static mesh assets, which needs the editor
+		if (Target.bBuildEditor)
+		{
+			PrivateDependencyModuleNames.AddRange(new string[] { "UnrealEd", "MeshDescription", "StaticMeshDescription" });
+		}
 	}
 }
@@ -10,6 +10,7 @@
 #include "EnhancedInputSubsystems.h"
 #include "InputActionValue.h"
 #include "Engine/LocalPlayer.h"
+#include "PerlinProcTerrain.h"
 
 DEFINE_LOG_CATEGORY(LogTemplateCharacter);
 
@@ -99,4 +100,12 @@ void AGAM415_GreenCharacter::Look(const FInputActionValue& Value)
 		AddControllerYawInput(LookAxisVector.X);
 		AddControllerPitchInput(LookAxisVector.Y);
 	}
-}
\ No newline at end of file
+}
+void AGAM415_GreenCharacter::ServerQueueDeformation_Implementation(APerlinProcTerrain* Terrain, FVector_NetQuantize ImpactPoint)
+{
+	// The terrain ignores impacts while it cannot deform, so nothing else needs checking here
+	if (Terrain != nullptr)
+	{
+		Terrain->QueueDeformation(ImpactPoint);
+	}
+}
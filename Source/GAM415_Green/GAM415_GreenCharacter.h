@@ -12,6 +12,7 @@ class USkeletalMeshComponent;
 class UCameraComponent;
 class UInputAction;
 class UInputMappingContext;
+class APerlinProcTerrain;
 struct FInputActionValue;
 
 DECLARE_LOG_CATEGORY_EXTERN(LogTemplateCharacter, Log, All);
@@ -66,6 +67,11 @@ public:
 	UPROPERTY(EditAnywhere)
 	bool isTeleporting;
 
+	/** Projectiles only exist on the machine that fired them, so a client's impact on a terrain is
+	 *  sent to the server here; the server queues the crater and replicates it to everyone */
+	UFUNCTION(Server, Reliable)
+	void ServerQueueDeformation(APerlinProcTerrain* Terrain, FVector_NetQuantize ImpactPoint);
+
 
 	/** Returns Mesh1P subobject **/
 	USkeletalMeshComponent* GetMesh1P() const { return Mesh1P; }
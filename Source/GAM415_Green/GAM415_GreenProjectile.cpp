@@ -29,6 +29,9 @@
 
 #include "PerlinProcTerrain.h"
 
+// The firing character, which forwards a client's terrain impacts to the server
+#include "GAM415_GreenCharacter.h"
+
 
 // Constructor: Sets default values and initializes components
 AGAM415_GreenProjectile::AGAM415_GreenProjectile()
@@ -138,8 +141,17 @@ void AGAM415_GreenProjectile::OnHit(UPrimitiveComponent* HitComp, AActor* OtherA
 				APerlinProcTerrain* pocTerrain = Cast<APerlinProcTerrain>(OtherActor);
 				if(pocTerrain)
 				{
-					// If the hit actor is a terrain, apply the color to the terrain's material
-					pocTerrain->AlterMesh(Hit.ImpactPoint);
+					// If the hit actor is a terrain, queue a crater; the terrain applies it within its frame budget.
+					// Projectiles are not replicated, so a client's shot asks the server to queue it instead.
+					AGAM415_GreenCharacter* Shooter = Cast<AGAM415_GreenCharacter>(GetInstigator());
+					if (pocTerrain->HasAuthority())
+					{
+						pocTerrain->QueueDeformation(Hit.ImpactPoint);
+					}
+					else if (Shooter && Shooter->IsLocallyControlled())
+					{
+						Shooter->ServerQueueDeformation(pocTerrain, Hit.ImpactPoint);
+					}
 				}
 			}
 		}
@@ -42,6 +42,10 @@ void UGAM415_GreenWeaponComponent::Fire()
 			//Set Spawn Collision Handling Override
 			FActorSpawnParameters ActorSpawnParams;
 			ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
+
+			// The projectile is only spawned on this machine; its instigator forwards terrain impacts to the server
+			ActorSpawnParams.Owner = Character;
+			ActorSpawnParams.Instigator = Character;
 	
 			// Spawn the projectile at the muzzle
 			World->SpawnActor<AGAM415_GreenProjectile>(ProjectileClass, SpawnLocation, SpawnRotation, ActorSpawnParams);
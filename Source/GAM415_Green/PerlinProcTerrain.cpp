@@ -5,138 +5,1463 @@
 #include "ProcMeshFromStatic.h"                // Custom utility for static mesh conversion (assumed)
 #include "ProcPlane.h"                         // Custom plane generation helper (assumed)
 #include "KismetProceduralMeshLibrary.h"       // Provides mesh manipulation utilities like slicing and copying
+#include "ProfilingDebugging/CpuProfilerTrace.h" // Named CPU scopes for Unreal Insights
+#include "Async/Async.h"                       // Hands finished asynchronous builds back to the game thread
+#include "Tasks/Task.h"                        // Runs asynchronous builds on worker tasks
+#include "GameFramework/PlayerController.h"    // View location for chunk LOD selection
+#include "GameFramework/Pawn.h"                // Player positions that streaming follows
+#include "TerrainHeightFieldComponent.h"        // Height-field collision
+#include "TerrainOctaveCache.h"                // Reused octave layers for editor previews
+#include "Components/StaticMeshComponent.h"    // Baked terrain tiles
+#include "Engine/StaticMesh.h"                 // Baked terrain tiles
+#include "Net/UnrealNetwork.h"                 // Replicated deformation snapshot
+#include "Algo/BinarySearch.h"                 // Keeps out-of-order deformation events sorted
+#include "UObject/ObjectSaveContext.h"         // Clearing the editor preview before a level save
 
 // Sets default values
 APerlinProcTerrain::APerlinProcTerrain()
 {
-	// Set this actor to call Tick() every frame. You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = false;
+	// Tick only drives chunk LOD selection and streaming, so it stays off unless BeginPlay needs it
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+
+	// Every client generates the terrain itself; only deformation events travel over the network.
+	// The terrain is relevant everywhere, so craters never go missing for distant players.
+	bReplicates = true;
+	bAlwaysRelevant = true;
 
 	// Create the procedural mesh component and attach it to the root (or pending root) component
 	ProcMesh = CreateDefaultSubobject<UProceduralMeshComponent>("Procedural Mesh");
 	ProcMesh->SetupAttachment(GetRootComponent());
+
+	// Cook chunk collision off the game thread when a deformed section is updated
+	ProcMesh->bUseAsyncCooking = true;
+
+	// Empty until a build hands it heights with bHeightFieldCollision set
+	HeightFieldCollision = CreateDefaultSubobject<UTerrainHeightFieldComponent>("Height Field Collision");
+	HeightFieldCollision->SetupAttachment(ProcMesh);
+}
+
+// Called when the game starts or when spawned
+void APerlinProcTerrain::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Generate the grid and upload it as one mesh section per chunk
+	BuildMesh();
+
+	// Only ever switch the tick on here: the build above may already have enabled it for a sliced
+	// upload, and snapshot events queued before BeginPlay enabled it to drain them. Tick puts
+	// itself back to sleep once none of that work is left.
+	if (bEnableLOD || bStreaming || IsBuilding() || PendingDeformations.Num() > 0)
+	{
+		SetActorTickEnabled(true);
+	}
+}
+
+// Cancels a build that would otherwise finish after the actor is gone
+void APerlinProcTerrain::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	CancelBuild();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void APerlinProcTerrain::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// Connected clients follow the multicast events; the snapshot only matters when a client joins
+	DOREPLIFETIME_CONDITION(APerlinProcTerrain, DeformSnapshot, COND_InitialOnly);
+}
+
+// Called every frame while bEnableLOD or bStreaming is set, a build is uploading, or deformations are queued
+void APerlinProcTerrain::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (NextUploadStep != INDEX_NONE)
+	{
+		UploadPendingSteps(UploadBudgetMs);
+	}
+
+	if (bStreaming)
+	{
+		UpdateStreaming();
+	}
+	else if (bEnableLOD)
+	{
+		UpdateLODs();
+	}
+
+	DrainDeformations(DeformationBudgetMs);
+
+	if (HasAuthority())
+	{
+		FlushDeformEvents();
+	}
+
+	// Go back to sleep once the queue is empty and nothing else needs the tick
+	if (PendingDeformations.Num() == 0 && OutgoingDeformEvents.Num() == 0 && NextUploadStep == INDEX_NONE && !bEnableLOD && !bStreaming)
+	{
+		SetActorTickEnabled(false);
+	}
+}
+
+// Generates the terrain grid and creates one mesh section per chunk, now or on worker tasks
+void APerlinProcTerrain::BuildMesh()
+{
+	// A newer build always supersedes one still in flight
+	CancelBuild();
+
+	// Resident streamed chunks are stale either way; in streaming mode Tick regenerates them
+	for (TPair<FIntPoint, TUniquePtr<FTerrainStreamedChunk>>& Pair : StreamedChunks)
+	{
+		RecycleStreamedChunk(MoveTemp(Pair.Value));
+	}
+	StreamedChunks.Reset();
+
+	// Tiles from an earlier bake are only kept while they are in use
+	for (UStaticMeshComponent* Tile : BakedTileComponents)
+	{
+		if (Tile)
+		{
+			Tile->DestroyComponent();
+		}
+	}
+	BakedTileComponents.Reset();
+
+	// Baked tiles replace generation entirely
+	if (UsesBakedTiles())
+	{
+		ProcMesh->ClearAllMeshSections();
+		HeightFieldCollision->ClearHeights();
+		Grid = FTerrainBuildData();
+		LoadBakedTiles();
+		OnTerrainBuilt.Broadcast(this);
+		return;
+	}
+
+	// Streaming builds nothing up front
+	if (bStreaming)
+	{
+		ProcMesh->ClearAllMeshSections();
+		HeightFieldCollision->ClearHeights();
+		Grid = FTerrainBuildData();
+		return;
+	}
+
+	TSharedRef<FTerrainBuildJob, ESPMode::ThreadSafe> Job = MakeShared<FTerrainBuildJob, ESPMode::ThreadSafe>();
+	Job->Data.Params = GetBuildParams();
+	TSharedRef<const FTerrainNoiseTable, ESPMode::ThreadSafe> Table = GetNoiseTable();
+
+	// Editor previews always build in the background and keep showing the previous result meanwhile
+	const bool bPreview = IsPreviewWorld();
+	if (!bAsyncBuild && !bPreview)
+	{
+		TerrainBuild::Run(Job->Data, *Table);
+		ApplyBuild(MoveTemp(Job->Data));
+		return;
+	}
+
+	// Previews are rebuilt after every tweak, mostly of one parameter, so keep their octave layers
+	if (bPreview && !OctaveCache.IsValid())
+	{
+		OctaveCache = MakeShared<FTerrainOctaveCache, ESPMode::ThreadSafe>();
+	}
+
+	PendingBuild = Job;
+	if (!bPreview)
+	{
+		SetBuildingState(true);
+	}
+
+	// Noise and chunk layout run on workers; chunk buffers are built as each one is uploaded here
+	UE::Tasks::Launch(UE_SOURCE_LOCATION, [WeakThis = TWeakObjectPtr<APerlinProcTerrain>(this), Job, Table, Cache = OctaveCache]()
+	{
+		if (!TerrainBuild::Run(Job->Data, *Table, &Job->bCancelled, Cache.Get()))
+		{
+			return;
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Job]()
+		{
+			APerlinProcTerrain* Terrain = WeakThis.Get();
+			if (Terrain && Terrain->PendingBuild.Get() == &Job.Get() && !Job->bCancelled)
+			{
+				Terrain->PendingBuild.Reset();
+				Terrain->ApplyBuild(MoveTemp(Job->Data));
+			}
+		});
+	});
+}
+
+// Flags the in-flight build so its worker stops and its result is discarded
+void APerlinProcTerrain::CancelBuild()
+{
+	if (PendingBuild.IsValid())
+	{
+		PendingBuild->bCancelled = true;
+		PendingBuild.Reset();
+	}
+
+	// Sections uploaded so far stay hidden until the next build replaces them
+	NextUploadStep = INDEX_NONE;
+}
+
+// Takes over a finished build and creates a mesh section per chunk
+void APerlinProcTerrain::ApplyBuild(FTerrainBuildData&& Data)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(APerlinProcTerrain::ApplyBuild);
+
+	// Drop any previous build so Regenerate starts from a clean slate
+	ProcMesh->ClearAllMeshSections();
+	Grid = MoveTemp(Data);
+
+	UE_LOG(LogTemp, Verbose, TEXT("%s: applied %dx%d terrain (%s, %.1f KB of %s heights)"),
+		*GetName(), Grid.Params.XSize, Grid.Params.YSize, Grid.bFromHeightCache ? TEXT("height cache") : TEXT("generated"),
+		Grid.Heights.GetAllocatedSize() / 1024.f, Grid.Heights.IsQuantized() ? TEXT("16-bit") : TEXT("float"));
+
+	// Debug: display the height values in the viewport for inspection (opt-in, allocates per vertex)
+	if (bShowDebugHeights && GEngine)
+	{
+		for (int32 i = 0; i < Grid.Heights.Num(); i++)
+		{
+			GEngine->AddOnScreenDebugMessage(-1, 999.0f, FColor::Yellow, FString::Printf(TEXT("Z: %f"), Grid.Heights.Get(i)));
+		}
+	}
+
+	// Sections are created from Tick within UploadBudgetMs per frame, or all at once without a budget.
+	// The terrain stays hidden until the last step has run.
+	NextUploadStep = 0;
+	SetBuildingState(true);
+
+	// Editor worlds do not tick actors, so a preview goes up in one go
+	UploadPendingSteps(IsPreviewWorld() ? 0.0 : UploadBudgetMs);
+
+	if (IsBuilding())
+	{
+		SetActorTickEnabled(true);
+	}
+}
+
+// Steps are one per chunk (section creation and material) followed by one for collision.
+// At least one step runs per call, so a budget smaller than a single step still makes progress.
+void APerlinProcTerrain::UploadPendingSteps(double BudgetMs)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(APerlinProcTerrain::UploadPendingSteps);
+
+	const double StartTime = FPlatformTime::Seconds();
+	const int32 NumSteps = Grid.Chunks.Num() + 1;
+
+	// Start distant chunks at their level of detail straight away rather than uploading full resolution first
+	FVector LocalView;
+	const bool bSelectLODs = bEnableLOD && GetLocalViewLocation(LocalView);
+
+	while (NextUploadStep != INDEX_NONE)
+	{
+		if (BudgetMs > 0.0 && NextUploadStep > 0 && (FPlatformTime::Seconds() - StartTime) * 1000.0 >= BudgetMs)
+		{
+			break;
+		}
+
+		if (NextUploadStep < Grid.Chunks.Num())
+		{
+			// Create a mesh section per chunk and apply the default material to each
+			FTerrainChunk& Chunk = Grid.Chunks[NextUploadStep];
+			if (bSelectLODs)
+			{
+				Chunk.CurrentLOD = SelectChunkLOD(Chunk, LocalView);
+			}
+
+			// Buffers are built just before their upload and dropped right after, so only one
+			// chunk's worth is alive at a time unless the terrain keeps them for deformation
+			EnsureChunkLOD(Chunk, Chunk.CurrentLOD);
+			UploadChunk(Chunk, true);
+			ProcMesh->SetMaterial(Chunk.SectionIndex, Mat);
+			ReleaseChunkBuffers(Chunk);
+			NextUploadStep++;
+		}
+		else
+		{
+			NextUploadStep = INDEX_NONE;
+			FinishBuild();
+		}
+
+		OnTerrainBuildProgress.Broadcast(this, NextUploadStep == INDEX_NONE ? 1.f : float(NextUploadStep) / NumSteps);
+	}
+}
+
+// Final game-thread step of a build: collision, saved deformations, and showing the result
+void APerlinProcTerrain::FinishBuild()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(APerlinProcTerrain::FinishBuild);
+
+	// One height field for the whole grid replaces the per-section trimesh colliders
+	if (UsesSectionCollision())
+	{
+		HeightFieldCollision->ClearHeights();
+	}
+	else
+	{
+		HeightFieldCollision->SetHeights(Grid, CollisionStep);
+	}
+
+	// Impacts still queued are merged against the new grid
+	for (FTerrainDeformRequest& Request : PendingDeformations)
+	{
+		Request.bHasFootprint = false;
+	}
+
+	// A fresh grid starts undeformed; saved deformations loaded during the build go on top
+	DeformJournal.Reset();
+	if (PendingJournal.Num() > 0)
+	{
+		ApplyJournal(PendingJournal);
+		PendingJournal.Empty();
+	}
+
+	SetBuildingState(false);
+	OnTerrainBuilt.Broadcast(this);
+}
+
+// Tiles keep the actor-space positions they were baked with, so they attach at the origin
+void APerlinProcTerrain::LoadBakedTiles()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(APerlinProcTerrain::LoadBakedTiles);
+
+	for (const TSoftObjectPtr<UStaticMesh>& BakedTile : BakedTiles)
+	{
+		UStaticMesh* TileMesh = BakedTile.LoadSynchronous();
+		if (!TileMesh)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("%s: baked tile %s is missing; re-run the TerrainBake commandlet"), *GetName(), *BakedTile.ToString());
+			continue;
+		}
+
+		UStaticMeshComponent* Tile = NewObject<UStaticMeshComponent>(this, NAME_None, RF_Transient);
+		Tile->SetStaticMesh(TileMesh);
+		Tile->SetupAttachment(ProcMesh);
+		Tile->RegisterComponent();
+		BakedTileComponents.Add(Tile);
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("%s: showing %d baked tiles"), *GetName(), BakedTileComponents.Num());
+}
+
+bool APerlinProcTerrain::IsPreviewWorld() const
+{
+	const UWorld* World = GetWorld();
+	return World && !World->IsGameWorld();
+}
+
+#if WITH_EDITOR
+// Only the parameters that change the generated grid trigger a preview
+void APerlinProcTerrain::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	if (!bLivePreview || !IsPreviewWorld())
+	{
+		return;
+	}
+
+	static const FName PreviewProperties[] =
+	{
+		GET_MEMBER_NAME_CHECKED(APerlinProcTerrain, Octaves),
+		GET_MEMBER_NAME_CHECKED(APerlinProcTerrain, Frequency),
+		GET_MEMBER_NAME_CHECKED(APerlinProcTerrain, Lacunarity),
+		GET_MEMBER_NAME_CHECKED(APerlinProcTerrain, Persistence),
+		GET_MEMBER_NAME_CHECKED(APerlinProcTerrain, ZMultiplier),
+		GET_MEMBER_NAME_CHECKED(APerlinProcTerrain, Seed),
+		GET_MEMBER_NAME_CHECKED(APerlinProcTerrain, NoiseType),
+		GET_MEMBER_NAME_CHECKED(APerlinProcTerrain, bRidge),
+		GET_MEMBER_NAME_CHECKED(APerlinProcTerrain, bBillow),
+		GET_MEMBER_NAME_CHECKED(APerlinProcTerrain, bUseFractalNoise),
+		GET_MEMBER_NAME_CHECKED(APerlinProcTerrain, NoiseScale),
+		GET_MEMBER_NAME_CHECKED(APerlinProcTerrain, XSize),
+		GET_MEMBER_NAME_CHECKED(APerlinProcTerrain, YSize),
+		GET_MEMBER_NAME_CHECKED(APerlinProcTerrain, Scale),
+		GET_MEMBER_NAME_CHECKED(APerlinProcTerrain, UVScale),
+		GET_MEMBER_NAME_CHECKED(APerlinProcTerrain, ChunkSize),
+		GET_MEMBER_NAME_CHECKED(APerlinProcTerrain, bUseBakedTiles),
+	};
+
+	if (MakeArrayView(PreviewProperties).Contains(PropertyChangedEvent.GetMemberPropertyName()))
+	{
+		// The build in flight is already stale; stop it now rather than when the delay expires
+		CancelBuild();
+		SchedulePreviewRebuild();
+	}
+}
+
+void APerlinProcTerrain::BeginDestroy()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(PreviewRebuildHandle);
+	PreviewRebuildHandle.Reset();
+
+	Super::BeginDestroy();
+}
+
+// The mesh component serializes its sections, so a preview left in place would embed the whole
+// full-resolution mesh in the level, only for BeginPlay to clear it again
+void APerlinProcTerrain::PreSave(FObjectPreSaveContext SaveContext)
+{
+	Super::PreSave(SaveContext);
+
+	if (!IsPreviewWorld() || (ProcMesh->GetNumSections() == 0 && !IsBuilding()))
+	{
+		return;
+	}
+
+	CancelBuild();
+	ProcMesh->ClearAllMeshSections();
+
+	// The rebuild ticks after the save has finished writing the package; cooks never need it
+	if (bLivePreview && !SaveContext.IsProceduralSave())
+	{
+		SchedulePreviewRebuild();
+	}
+}
+
+// Every edit pushes the rebuild back, so a burst of changes builds once
+void APerlinProcTerrain::SchedulePreviewRebuild()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(PreviewRebuildHandle);
+	PreviewRebuildHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateWeakLambda(this, [this](float)
+	{
+		PreviewRebuildHandle.Reset();
+		BuildMesh();
+		return false;
+	}), PreviewRebuildDelay);
+}
+#endif
+
+// Keeps a half-built terrain from being seen or collided with
+void APerlinProcTerrain::SetBuildingState(bool bBuilding)
+{
+	ProcMesh->SetVisibility(!bBuilding);
+	ProcMesh->SetCollisionEnabled(bBuilding ? ECollisionEnabled::NoCollision : ECollisionEnabled::QueryAndPhysics);
+	HeightFieldCollision->SetCollisionEnabled(bBuilding ? ECollisionEnabled::NoCollision : ECollisionEnabled::QueryAndPhysics);
+}
+
+// Snapshot of the actor properties generation reads
+FTerrainBuildParams APerlinProcTerrain::GetBuildParams() const
+{
+	FTerrainBuildParams Params;
+	Params.XSize = XSize;
+	Params.YSize = YSize;
+	Params.Scale = Scale;
+	Params.UVScale = UVScale;
+	Params.ZMultiplier = ZMultiplier;
+	Params.NoiseScale = NoiseScale;
+	Params.ChunkSize = ChunkSize;
+	Params.bUseFractalNoise = bUseFractalNoise;
+	Params.Noise = GetNoiseSettings();
+	Params.SkirtDepth = bEnableLOD ? SkirtDepth : 0.f;
+	Params.bUseHeightCache = bUseHeightCache;
+	Params.bQuantizeHeights = bQuantizeHeights;
+	Params.bSplatColors = bSplatColors;
+	Params.RockSlopeStart = RockSlopeStart;
+	Params.RockSlopeEnd = FMath::Max(RockSlopeEnd, RockSlopeStart);
+	Params.SnowHeight = SnowHeight;
+	Params.SnowBlend = SnowBlend;
+	return Params;
+}
+
+// Alters the mesh dynamically based on an impact point (e.g., for terrain deformation)
+FTerrainDeformStats APerlinProcTerrain::AlterMesh(FVector impactPoint)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(APerlinProcTerrain::AlterMesh);
+
+	if (!bDeformable || UsesBakedTiles())
+	{
+		return FTerrainDeformStats();
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	// Get local-space vector from actor origin to impact point
+	FVector tempVector = impactPoint - this->GetActorLocation();
+
+	// Gather every affected vertex first so the mesh is only touched once per impact
+	TArray<int32> Affected;
+	CollectCraterVertices(tempVector, radius, Affected);
+
+	FTerrainDeformStats Stats;
+	Stats.VerticesTouched = Affected.Num();
+	Stats.SectionsUpdated = ApplyDeformation(Affected, Depth);
+	Stats.Milliseconds = float((FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+	UE_LOG(LogTemp, Verbose, TEXT("%s: crater moved %d vertices, updated %d sections in %.3f ms"),
+		*GetName(), Stats.VerticesTouched, Stats.SectionsUpdated, Stats.Milliseconds);
+
+	LastDeformStats = Stats;
+	return Stats;
+}
+
+// Collects the grid index of every vertex within Radius of LocalCenter
+void APerlinProcTerrain::CollectCraterVertices(const FVector& LocalCenter, float Radius, TArray<int32>& OutIndices) const
+{
+	OutIndices.Reset();
+
+	// Only the vertices inside the crater's grid footprint can be hit, so test just those
+	const FIntRect Range = GetVertexRangeInRadius(LocalCenter, Radius);
+
+	for (int32 X = Range.Min.X; X <= Range.Max.X; X++)
+	{
+		for (int32 Y = Range.Min.Y; Y <= Range.Max.Y; Y++)
+		{
+			// If the vertex is within the radius of the impact it will be lowered
+			if (FVector(Grid.GetVertex(X, Y) - LocalCenter).Size() < Radius)
+			{
+				OutIndices.Add(Grid.GetVertexIndex(X, Y));
+			}
+		}
+	}
+}
+
+// Grid rectangle covering the XY footprint of a sphere, clamped to the grid
+FIntRect APerlinProcTerrain::GetVertexRangeInRadius(const FVector& LocalCenter, float InRadius) const
+{
+	// An empty rectangle makes callers' loops run zero times
+	const FIntRect Empty(FIntPoint(0, 0), FIntPoint(-1, -1));
+
+	if (Grid.Heights.Num() == 0 || Grid.Params.Scale <= 0.f || InRadius <= 0.f)
+	{
+		return Empty;
+	}
+
+	const FIntPoint Min(FMath::CeilToInt((LocalCenter.X - InRadius) / Grid.Params.Scale), FMath::CeilToInt((LocalCenter.Y - InRadius) / Grid.Params.Scale));
+	const FIntPoint Max(FMath::FloorToInt((LocalCenter.X + InRadius) / Grid.Params.Scale), FMath::FloorToInt((LocalCenter.Y + InRadius) / Grid.Params.Scale));
+
+	if (Max.X < 0 || Max.Y < 0 || Min.X > Grid.Params.XSize || Min.Y > Grid.Params.YSize)
+	{
+		return Empty;
+	}
+
+	return FIntRect(
+		FIntPoint(FMath::Max(Min.X, 0), FMath::Max(Min.Y, 0)),
+		FIntPoint(FMath::Min(Max.X, Grid.Params.XSize), FMath::Min(Max.Y, Grid.Params.YSize)));
+}
+
+// Rounds a world location to the closest grid vertex
+int32 APerlinProcTerrain::FindNearestVertex(FVector WorldLocation) const
+{
+	if (Grid.Heights.Num() == 0 || Grid.Params.Scale <= 0.f)
+	{
+		return INDEX_NONE;
+	}
+
+	const FVector Local = WorldLocation - GetActorLocation();
+	const int32 X = FMath::RoundToInt(Local.X / Grid.Params.Scale);
+	const int32 Y = FMath::RoundToInt(Local.Y / Grid.Params.Scale);
+
+	if (X < 0 || Y < 0 || X > Grid.Params.XSize || Y > Grid.Params.YSize)
+	{
+		return INDEX_NONE;
+	}
+
+	return Grid.GetVertexIndex(X, Y);
+}
+
+// Interpolates between the four vertices of the grid cell containing LocalXY
+bool APerlinProcTerrain::GetHeightBilinear(const FVector2D& LocalXY, float& OutZ) const
+{
+	return SampleSurface(LocalXY, OutZ, nullptr);
+}
+
+// In streaming mode the point is looked up in the resident chunk covering it
+bool APerlinProcTerrain::SampleSurface(const FVector2D& LocalXY, float& OutZ, FVector* OutNormal) const
+{
+	if (Scale <= 0.f)
+	{
+		return false;
+	}
+
+	if (!bStreaming)
+	{
+		return Grid.Params.Scale > 0.f && Grid.SampleBilinear(LocalXY / Grid.Params.Scale, OutZ, OutNormal);
+	}
+
+	const double ChunkWorldSize = double(FMath::Max(1, ChunkSize)) * Scale;
+	const FIntPoint Coord(FMath::FloorToInt(LocalXY.X / ChunkWorldSize), FMath::FloorToInt(LocalXY.Y / ChunkWorldSize));
+	const TUniquePtr<FTerrainStreamedChunk>* Chunk = StreamedChunks.Find(Coord);
+	if (!Chunk)
+	{
+		return false;
+	}
+
+	const FTerrainBuildData& Data = (*Chunk)->Data;
+	return Data.SampleBilinear(LocalXY / Data.Params.Scale - FVector2D(Data.Params.Origin), OutZ, OutNormal);
+}
+
+bool APerlinProcTerrain::GetHeightAtLocation(FVector WorldLocation, float& OutHeight) const
+{
+	float LocalZ = 0.f;
+	if (!SampleSurface(FVector2D(WorldLocation - GetActorLocation()), LocalZ, nullptr))
+	{
+		return false;
+	}
+
+	OutHeight = float(GetActorLocation().Z) + LocalZ;
+	return true;
+}
+
+bool APerlinProcTerrain::GetNormalAtLocation(FVector WorldLocation, FVector& OutNormal) const
+{
+	float LocalZ = 0.f;
+	return SampleSurface(FVector2D(WorldLocation - GetActorLocation()), LocalZ, &OutNormal);
+}
+
+int32 APerlinProcTerrain::GetSurfaceAtLocations(const TArray<FVector>& WorldLocations, TArray<FVector>& OutPoints, TArray<FVector>& OutNormals, TArray<bool>& OutHits) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(APerlinProcTerrain::GetSurfaceAtLocations);
+
+	OutPoints.SetNumUninitialized(WorldLocations.Num());
+	OutNormals.SetNumUninitialized(WorldLocations.Num());
+	OutHits.SetNumUninitialized(WorldLocations.Num());
+
+	const FVector ActorLocation = GetActorLocation();
+	int32 NumHits = 0;
+
+	for (int32 i = 0; i < WorldLocations.Num(); i++)
+	{
+		float LocalZ = 0.f;
+		OutHits[i] = SampleSurface(FVector2D(WorldLocations[i] - ActorLocation), LocalZ, &OutNormals[i]);
+
+		// Misses keep the query point and report straight up, so the arrays stay usable as-is
+		OutPoints[i] = FVector(WorldLocations[i].X, WorldLocations[i].Y, OutHits[i] ? ActorLocation.Z + LocalZ : WorldLocations[i].Z);
+		if (!OutHits[i])
+		{
+			OutNormals[i] = FVector::UpVector;
+		}
+		NumHits += OutHits[i] ? 1 : 0;
+	}
+
+	return NumHits;
+}
+
+// Applies Offset to each collected vertex once, then re-uploads every overlapped chunk once.
+// Returns the number of mesh sections that were updated.
+int32 APerlinProcTerrain::ApplyDeformation(TConstArrayView<int32> Indices, const FVector& Offset)
+{
+	return RefreshDeformedRegion(DisplaceVertices(Indices, Offset));
+}
+
+// Lowers each listed vertex by Offset.Z (a vertex listed twice moves twice) and returns their grid bounds,
+// or the whole grid if quantized heights had to be re-encoded.
+// Only heights are stored, so the lateral part of Offset has no effect.
+FIntRect APerlinProcTerrain::DisplaceVertices(TConstArrayView<int32> Indices, const FVector& Offset)
+{
+	// Grid-space bounds of every vertex the crater moved
+	FIntPoint DirtyMin(MAX_int32, MAX_int32);
+	FIntPoint DirtyMax(MIN_int32, MIN_int32);
+	bool bReencoded = false;
+
+	for (const int32 i : Indices)
+	{
+		// Journal the change actually stored, which quantized heights may round
+		const float OldZ = Grid.Heights.Get(i);
+		bReencoded |= Grid.Heights.Set(i, OldZ - float(Offset.Z));
+		DeformJournal.Add(i, Grid.Heights.Get(i) - OldZ);
+
+		const FIntPoint GridPoint = Grid.GetVertexCoord(i);
+		DirtyMin = DirtyMin.ComponentMin(GridPoint);
+		DirtyMax = DirtyMax.ComponentMax(GridPoint);
+	}
+
+	// A widened quantization range nudges every stored height, so the whole terrain is refreshed
+	if (bReencoded)
+	{
+		UE_LOG(LogTemp, Verbose, TEXT("%s: crater left the quantized height range; refreshing the whole terrain"), *GetName());
+		return FIntRect(0, 0, Grid.Params.XSize, Grid.Params.YSize);
+	}
+	return FIntRect(DirtyMin, DirtyMax);
+}
+
+// Brings normals, collision and every overlapped section up to date with the moved vertices
+int32 APerlinProcTerrain::RefreshDeformedRegion(const FIntRect& Moved)
+{
+	if (Moved.Max.X < Moved.Min.X || Moved.Max.Y < Moved.Min.Y)
+	{
+		return 0;
+	}
+
+	// A vertex's normal depends on its neighbours' heights, so the ring just outside the crater
+	// changes too; only vertices inside that rectangle are rewritten
+	const FIntPoint DirtyMin = (Moved.Min - FIntPoint(1, 1)).ComponentMax(FIntPoint(0, 0));
+	const FIntPoint DirtyMax = (Moved.Max + FIntPoint(1, 1)).ComponentMin(FIntPoint(Grid.Params.XSize, Grid.Params.YSize));
+
+	// Patch just the covered height field cells; sections then update without re-cooking anything
+	if (!UsesSectionCollision())
+	{
+		HeightFieldCollision->UpdateHeights(Grid, FIntRect(DirtyMin, DirtyMax));
+	}
+
+	// Re-upload only the chunks the dirty rectangle overlaps; border vertices live in two chunks
+	int32 SectionsUpdated = 0;
+	for (FTerrainChunk& Chunk : Grid.Chunks)
+	{
+		if (Chunk.Max.X < DirtyMin.X || Chunk.Min.X > DirtyMax.X || Chunk.Max.Y < DirtyMin.Y || Chunk.Min.Y > DirtyMax.Y)
+		{
+			continue;
+		}
+
+		// Other levels of detail are stale now; they are regenerated if the chunk switches back to them
+		for (int32 LOD = 0; LOD < Chunk.LODs.Num(); LOD++)
+		{
+			if (LOD != Chunk.CurrentLOD)
+			{
+				Chunk.LODs[LOD] = FTerrainChunkMesh();
+			}
+		}
+
+		// A chunk whose buffers were released rebuilds them from the already moved heights; otherwise
+		// just the rectangle's vertices are refreshed. A coarse level may sample none of them.
+		if (!Chunk.LODs.IsValidIndex(Chunk.CurrentLOD) || Chunk.LODs[Chunk.CurrentLOD].IsEmpty())
+		{
+			EnsureChunkLOD(Chunk, Chunk.CurrentLOD);
+		}
+		else if (!TerrainBuild::FillChunkVertices(Grid, Chunk, Chunk.CurrentLOD, Chunk.LODs[Chunk.CurrentLOD], FIntRect(DirtyMin, DirtyMax)))
+		{
+			continue;
+		}
+		UploadChunk(Chunk, false);
+		SectionsUpdated++;
+	}
+
+	return SectionsUpdated;
+}
+
+void APerlinProcTerrain::SaveDeformations(TArray<uint8>& OutBytes) const
+{
+	// A journal still waiting for the build is the most recent state
+	if (PendingJournal.Num() > 0)
+	{
+		OutBytes = PendingJournal;
+		return;
+	}
+
+	DeformJournal.Save(Grid.Params, OutBytes);
+}
+
+bool APerlinProcTerrain::LoadDeformations(const TArray<uint8>& Bytes)
+{
+	if (bStreaming)
+	{
+		return false;
+	}
+
+	// Nothing to apply the journal to yet; ApplyBuild picks it up
+	if (IsBuilding() || Grid.Heights.Num() == 0)
+	{
+		PendingJournal = Bytes;
+		return true;
+	}
+
+	return ApplyJournal(Bytes);
 }
 
-// Called when the game starts or when spawned
-void APerlinProcTerrain::BeginPlay()
+// Undoing the current journal first returns the grid to its generated heights, so loading the
+// same journal twice, or one from an earlier save, never stacks craters
+bool APerlinProcTerrain::ApplyJournal(TConstArrayView<uint8> Bytes)
 {
-	Super::BeginPlay();
+	TRACE_CPUPROFILER_EVENT_SCOPE(APerlinProcTerrain::ApplyJournal);
+
+	const double StartTime = FPlatformTime::Seconds();
 
-	// Generate the vertex positions and UVs using Perlin noise
-	CreateVertices();
+	FTerrainDeformJournal Loaded;
+	if (!Loaded.Load(Grid.Params, Bytes))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s: ignoring deformation journal recorded for a different terrain"), *GetName());
+		return false;
+	}
+
+	const FIntRect Undone = DeformJournal.Apply(Grid.Heights, Grid.Params, -1.f);
+	const FIntRect Applied = Loaded.Apply(Grid.Heights, Grid.Params);
+	DeformJournal = MoveTemp(Loaded);
+
+	const FIntRect Moved(Undone.Min.ComponentMin(Applied.Min), Undone.Max.ComponentMax(Applied.Max));
+	const int32 SectionsUpdated = RefreshDeformedRegion(Moved);
 
-	// Define triangle indices to form mesh faces from the generated vertices
-	CreateTriangles();
+	// Clients that join later start from the loaded state; connected clients are not resent it
+	if (HasAuthority() && GetNetMode() != NM_Standalone && PendingDeformations.Num() == 0)
+	{
+		CaptureDeformSnapshot();
+	}
 
-	// Create a mesh section from the generated data and apply the default material
-	ProcMesh->CreateMeshSection(sectionID, Vertices, Triangles, Normals, UV0, UpVertexColors, TArray<FProcMeshTangent>(), true);
-	ProcMesh->SetMaterial(0, Mat);
+	UE_LOG(LogTemp, Verbose, TEXT("%s: restored %d deformed vertices (%d bytes), updated %d sections in %.3f ms"),
+		*GetName(), DeformJournal.Num(), Bytes.Num(), SectionsUpdated, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+	return true;
 }
 
-// Called every frame (disabled in constructor, but available if needed)
-void APerlinProcTerrain::Tick(float DeltaTime)
+// Records an impact for the next Tick instead of deforming straight away. Clients leave impacts to
+// the server, which queues the quantized event itself so every machine applies identical craters.
+void APerlinProcTerrain::QueueDeformation(FVector ImpactPoint)
 {
-	Super::Tick(DeltaTime);
+	if (!bDeformable || UsesBakedTiles() || !HasAuthority())
+	{
+		return;
+	}
+
+	// NetSerialize rounds the position on the wire; round it here too so the server matches its clients
+	FTerrainDeformEvent Event;
+	Event.Sequence = DeformEventOrder.LastSequence + 1;
+	Event.LocalCenter = (ImpactPoint - GetActorLocation()).RoundToVector();
+	Event.RadiusClass = GetRadiusClass(radius);
+
+	QueueDeformEvent(Event);
+
+	if (GetNetMode() != NM_Standalone || bRecordDeformEventsStandalone)
+	{
+		OutgoingDeformEvents.Add(Event);
+		DeformSnapshot.Tail.Add(Event);
+	}
 }
 
-// Alters the mesh dynamically based on an impact point (e.g., for terrain deformation)
-void APerlinProcTerrain::AlterMesh(FVector impactPoint)
+void APerlinProcTerrain::QueueDeformEvent(const FTerrainDeformEvent& Event)
+{
+	TArray<FTerrainDeformEvent> Ready;
+	DeformEventOrder.Receive(Event, Ready);
+	QueueOrderedDeformEvents(Ready);
+
+	if (DeformEventOrder.Held.Num() > 0)
+	{
+		UE_LOG(LogTemp, Verbose, TEXT("%s: holding %d deformation events until event %u arrives"),
+			*GetName(), DeformEventOrder.Held.Num(), DeformEventOrder.LastSequence + 1);
+	}
+}
+
+void APerlinProcTerrain::QueueOrderedDeformEvents(TConstArrayView<FTerrainDeformEvent> Events)
+{
+	for (const FTerrainDeformEvent& Event : Events)
+	{
+		FTerrainDeformRequest& Request = PendingDeformations.AddDefaulted_GetRef();
+		Request.LocalCenter = Event.LocalCenter;
+		Request.Radius = GetClassRadius(Event.RadiusClass);
+		Request.Offset = Depth;
+
+		if (!IsBuilding() && Grid.Heights.Num() > 0)
+		{
+			Request.Footprint = GetVertexRangeInRadius(Request.LocalCenter, Request.Radius);
+			Request.bHasFootprint = true;
+		}
+	}
+
+	if (Events.Num() > 0)
+	{
+		SetActorTickEnabled(true);
+	}
+}
+
+void APerlinProcTerrain::MulticastDeformEvents_Implementation(const TArray<FTerrainDeformEvent>& Events)
+{
+	// The server queued these when they were made
+	if (HasAuthority())
+	{
+		return;
+	}
+
+	for (const FTerrainDeformEvent& Event : Events)
+	{
+		QueueDeformEvent(Event);
+	}
+}
+
+void APerlinProcTerrain::FlushDeformEvents()
+{
+	if (OutgoingDeformEvents.Num() > 0)
+	{
+		MulticastDeformEvents(OutgoingDeformEvents);
+		OutgoingDeformEvents.Reset();
+	}
+
+	// The journal only holds applied craters, so it is captured when nothing is left in the queue;
+	// until then late joiners replay the tail on top of the previous capture
+	if (DeformSnapshot.Tail.Num() >= SnapshotTailLength && PendingDeformations.Num() == 0)
+	{
+		CaptureDeformSnapshot();
+	}
+}
+
+void APerlinProcTerrain::CaptureDeformSnapshot()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(APerlinProcTerrain::CaptureDeformSnapshot);
+
+	TArray<uint8> Bytes;
+	DeformJournal.Save(Grid.Params, Bytes);
+	FTerrainDeformJournal::Compress(Bytes, DeformSnapshot.Journal);
+	DeformSnapshot.Sequence = DeformEventOrder.LastSequence;
+	DeformSnapshot.Tail.Reset();
+
+	UE_LOG(LogTemp, Verbose, TEXT("%s: captured deformation snapshot at event %u (%d bytes, %d compressed)"),
+		*GetName(), DeformSnapshot.Sequence, Bytes.Num(), DeformSnapshot.Journal.Num());
+}
+
+// Late joiners load the journal first, then queue the tail; the journal waits for the build if needed.
+// Tail events come after the journal's last event, so the journal's events are marked as applied
+// even if it fails to load, rather than holding the tail back for good.
+void APerlinProcTerrain::OnRep_DeformSnapshot()
+{
+	if (DeformSnapshot.Journal.Num() > 0)
+	{
+		TArray<uint8> Bytes;
+		if (!FTerrainDeformJournal::Decompress(DeformSnapshot.Journal, Bytes) || !LoadDeformations(Bytes))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("%s: could not load the replicated deformation snapshot"), *GetName());
+		}
+	}
+
+	TArray<FTerrainDeformEvent> Ready;
+	DeformEventOrder.SkipTo(DeformSnapshot.Sequence, Ready);
+	QueueOrderedDeformEvents(Ready);
+
+	for (const FTerrainDeformEvent& Event : DeformSnapshot.Tail)
+	{
+		QueueDeformEvent(Event);
+	}
+}
+
+uint8 APerlinProcTerrain::GetRadiusClass(float InRadius) const
+{
+	int32 Best = 0;
+	const int32 NumClasses = FMath::Min(RadiusClasses.Num(), 16);
+	for (int32 i = 1; i < NumClasses; i++)
+	{
+		if (FMath::Abs(RadiusClasses[i] - InRadius) < FMath::Abs(RadiusClasses[Best] - InRadius))
+		{
+			Best = i;
+		}
+	}
+	return uint8(Best);
+}
+
+float APerlinProcTerrain::GetClassRadius(uint8 RadiusClass) const
+{
+	return RadiusClasses.IsValidIndex(RadiusClass) ? RadiusClasses[RadiusClass] : radius;
+}
+
+bool FTerrainDeformEventOrder::Receive(const FTerrainDeformEvent& Event, TArray<FTerrainDeformEvent>& OutReady)
+{
+	if (Event.Sequence <= LastSequence || Held.ContainsByPredicate([&Event](const FTerrainDeformEvent& Other) { return Other.Sequence == Event.Sequence; }))
+	{
+		return false;
+	}
+
+	if (Event.Sequence != LastSequence + 1)
+	{
+		const int32 Index = Algo::LowerBoundBy(Held, Event.Sequence, &FTerrainDeformEvent::Sequence);
+		Held.Insert(Event, Index);
+		return true;
+	}
+
+	OutReady.Add(Event);
+	LastSequence = Event.Sequence;
+	ReleaseHeld(OutReady);
+	return true;
+}
+
+void FTerrainDeformEventOrder::SkipTo(uint32 Sequence, TArray<FTerrainDeformEvent>& OutReady)
+{
+	if (Sequence <= LastSequence)
+	{
+		return;
+	}
+
+	LastSequence = Sequence;
+	Held.RemoveAll([Sequence](const FTerrainDeformEvent& Event) { return Event.Sequence <= Sequence; });
+	ReleaseHeld(OutReady);
+}
+
+void FTerrainDeformEventOrder::ReleaseHeld(TArray<FTerrainDeformEvent>& OutReady)
+{
+	int32 NumReleased = 0;
+	while (NumReleased < Held.Num() && Held[NumReleased].Sequence == LastSequence + 1)
+	{
+		OutReady.Add(Held[NumReleased]);
+		LastSequence = Held[NumReleased].Sequence;
+		NumReleased++;
+	}
+	Held.RemoveAt(0, NumReleased);
+}
+
+bool FTerrainDeformEvent::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	Ar.SerializeIntPacked(Sequence);
+
+	// Whole units are far finer than any crater, and keep the packed vector small
+	LocalCenter.NetSerialize(Ar, Map, bOutSuccess);
+
+	uint32 Class = RadiusClass;
+	Ar.SerializeInt(Class, 16);
+	RadiusClass = uint8(Class);
+
+	bOutSuccess = bOutSuccess && !Ar.IsError();
+	return true;
+}
+
+// Each batch starts from the oldest queued crater and absorbs every queued crater whose footprint
+// touches the batch, so a burst of hits in one spot costs one normal pass and one upload per chunk
+int32 APerlinProcTerrain::DrainDeformations(double BudgetMs)
 {
-	for (int i = 0; i < Vertices.Num(); i++)
+	TRACE_CPUPROFILER_EVENT_SCOPE(APerlinProcTerrain::DrainDeformations);
+
+	const double StartTime = FPlatformTime::Seconds();
+	int32 NumBatches = 0;
+
+	TArray<int32> CraterIndices;
+	TArray<int32, TInlineAllocator<16>> BatchMembers;
+	TBitArray<> InBatch;
+
+	// Impacts queued before the grid existed get their footprint here, once
+	if (!IsBuilding())
 	{
-		// Get local-space vector from actor origin to impact point
-		FVector tempVector = impactPoint - this->GetActorLocation();
+		for (FTerrainDeformRequest& Request : PendingDeformations)
+		{
+			if (!Request.bHasFootprint)
+			{
+				Request.Footprint = GetVertexRangeInRadius(Request.LocalCenter, Request.Radius);
+				Request.bHasFootprint = true;
+			}
+		}
+	}
+
+	while (PendingDeformations.Num() > 0 && !IsBuilding())
+	{
+		// Always make progress, then carry whatever is left into the next frame
+		if (NumBatches > 0 && (FPlatformTime::Seconds() - StartTime) * 1000.0 >= BudgetMs)
+		{
+			break;
+		}
+
+		// Grow the batch until no remaining crater overlaps its footprint
+		FIntRect BatchRect = PendingDeformations[0].Footprint;
+		BatchMembers.Reset();
+		BatchMembers.Add(0);
+		InBatch.Init(false, PendingDeformations.Num());
+		InBatch[0] = true;
 
-		// If the vertex is within a specified radius of the impact, lower it by Depth
-		if (FVector(Vertices[i] - tempVector).Size() < radius)
+		for (bool bGrew = true; bGrew; )
 		{
-			Vertices[i] = Vertices[i] - Depth;
+			bGrew = false;
+			for (int32 i = 1; i < PendingDeformations.Num(); i++)
+			{
+				if (InBatch[i])
+				{
+					continue;
+				}
+
+				const FIntRect& Footprint = PendingDeformations[i].Footprint;
+				const bool bOverlaps = Footprint.Min.X <= BatchRect.Max.X && Footprint.Max.X >= BatchRect.Min.X
+					&& Footprint.Min.Y <= BatchRect.Max.Y && Footprint.Max.Y >= BatchRect.Min.Y;
+
+				if (bOverlaps)
+				{
+					BatchMembers.Add(i);
+					InBatch[i] = true;
+					BatchRect.Min = BatchRect.Min.ComponentMin(Footprint.Min);
+					BatchRect.Max = BatchRect.Max.ComponentMax(Footprint.Max);
+					bGrew = true;
+				}
+			}
+		}
+
+		// Oldest first, so overlapping craters stack exactly as they would have one by one
+		BatchMembers.Sort();
+
+		const double BatchStart = FPlatformTime::Seconds();
+		FTerrainDeformStats Stats;
+		FIntRect Moved(FIntPoint(MAX_int32, MAX_int32), FIntPoint(MIN_int32, MIN_int32));
+
+		for (const int32 Member : BatchMembers)
+		{
+			const FTerrainDeformRequest& Request = PendingDeformations[Member];
+			CollectCraterVertices(Request.LocalCenter, Request.Radius, CraterIndices);
+			if (CraterIndices.Num() == 0)
+			{
+				continue;
+			}
+
+			const FIntRect CraterMoved = DisplaceVertices(CraterIndices, Request.Offset);
+			Moved.Min = Moved.Min.ComponentMin(CraterMoved.Min);
+			Moved.Max = Moved.Max.ComponentMax(CraterMoved.Max);
+			Stats.VerticesTouched += CraterIndices.Num();
+		}
+
+		Stats.SectionsUpdated = RefreshDeformedRegion(Moved);
+		Stats.Milliseconds = float((FPlatformTime::Seconds() - BatchStart) * 1000.0);
+		LastDeformStats = Stats;
 
-			// Update the mesh with the new vertex positions
-			ProcMesh->UpdateMeshSection(sectionID, Vertices, Normals, UV0, UpVertexColors, TArray<FProcMeshTangent>());
+		UE_LOG(LogTemp, Verbose, TEXT("%s: merged %d craters, moved %d vertices, updated %d sections in %.3f ms"),
+			*GetName(), BatchMembers.Num(), Stats.VerticesTouched, Stats.SectionsUpdated, Stats.Milliseconds);
+
+		// Compact the queue in one pass, keeping the remaining impacts in order
+		int32 NumKept = 0;
+		for (int32 i = 0; i < PendingDeformations.Num(); i++)
+		{
+			if (!InBatch[i])
+			{
+				PendingDeformations[NumKept++] = MoveTemp(PendingDeformations[i]);
+			}
 		}
+		PendingDeformations.SetNum(NumKept, EAllowShrinking::No);
+		NumBatches++;
+	}
+
+	return NumBatches;
+}
+
+// Creates the chunk's mesh section on first upload and updates it in place afterwards
+void APerlinProcTerrain::UploadChunk(const FTerrainChunk& Chunk, bool bCreate)
+{
+	const FTerrainChunkMesh& Mesh = Chunk.GetCurrentMesh();
+	NumUploadedVertices += Mesh.Vertices.Num();
+
+	if (bCreate)
+	{
+		ProcMesh->CreateMeshSection(Chunk.SectionIndex, Mesh.Vertices, *Mesh.Triangles, Mesh.Normals, Mesh.UV0, Mesh.Colors, Mesh.Tangents, UsesSectionCollision());
+	}
+	else
+	{
+		ProcMesh->UpdateMeshSection(Chunk.SectionIndex, Mesh.Vertices, Mesh.Normals, Mesh.UV0, Mesh.Colors, Mesh.Tangents);
+	}
+}
+
+// Builds a level of detail whose buffers were never generated or have been released
+void APerlinProcTerrain::EnsureChunkLOD(FTerrainChunk& Chunk, int32 LOD)
+{
+	if (!Chunk.LODs.IsValidIndex(LOD) || Chunk.LODs[LOD].IsEmpty())
+	{
+		TerrainBuild::BuildChunkLOD(Grid, Chunk, LOD);
+	}
+}
+
+// The section keeps its own copy of the uploaded buffers, so a terrain that is never deformed has no
+// use for ours; everything can be rebuilt from the heights if a level of detail is needed again
+void APerlinProcTerrain::ReleaseChunkBuffers(FTerrainChunk& Chunk)
+{
+	if (bDeformable)
+	{
+		return;
+	}
+
+	for (FTerrainChunkMesh& Mesh : Chunk.LODs)
+	{
+		Mesh = FTerrainChunkMesh();
+	}
+}
+
+// Uses the first local player's camera; LOD is a purely visual concern
+bool APerlinProcTerrain::GetLocalViewLocation(FVector& OutLocation) const
+{
+	const UWorld* World = GetWorld();
+	const APlayerController* PlayerController = World ? World->GetFirstPlayerController() : nullptr;
+	if (!PlayerController || !PlayerController->IsLocalController())
+	{
+		return false;
+	}
+
+	FRotator ViewRotation;
+	PlayerController->GetPlayerViewPoint(OutLocation, ViewRotation);
+	OutLocation -= GetActorLocation();
+	return true;
+}
+
+// Each level covers a band twice as wide as the previous one, starting at LODDistance
+int32 APerlinProcTerrain::SelectChunkLOD(const FTerrainChunk& Chunk, const FVector& LocalView) const
+{
+	// Horizontal distance to the nearest point of the chunk, so large chunks refine as soon as the view enters them
+	const FBox2D Bounds(FVector2D(Chunk.Min) * Grid.Params.Scale, FVector2D(Chunk.Max) * Grid.Params.Scale);
+	return GetLODForDistance(FMath::Sqrt(Bounds.ComputeSquaredDistanceToPoint(FVector2D(LocalView))));
+}
+
+// Each level starts at twice the distance of the previous one
+int32 APerlinProcTerrain::GetLODForDistance(float Distance) const
+{
+	if (LODDistance <= 0.f)
+	{
+		return 0;
 	}
+
+	int32 LOD = 0;
+	while (LOD < MaxLOD && Distance >= LODDistance * float(1 << LOD))
+	{
+		LOD++;
+	}
+	return LOD;
 }
 
-// Creates vertices and UVs for a grid-based terrain using Perlin noise for height variation
-void APerlinProcTerrain::CreateVertices()
+// Re-creates the section of every chunk whose level of detail changed since the last update
+void APerlinProcTerrain::UpdateLODs()
 {
-	for (int X = 0; X <= XSize; X++)
+	TRACE_CPUPROFILER_EVENT_SCOPE(APerlinProcTerrain::UpdateLODs);
+
+	FVector LocalView;
+	if (IsBuilding() || !GetLocalViewLocation(LocalView))
 	{
-		for (int Y = 0; Y <= YSize; Y++)
+		return;
+	}
+
+	for (FTerrainChunk& Chunk : Grid.Chunks)
+	{
+		const int32 LOD = SelectChunkLOD(Chunk, LocalView);
+		if (LOD == Chunk.CurrentLOD)
 		{
-			// Generate a Perlin noise value based on scaled X and Y positions
-			float Z = FMath::PerlinNoise2D(FVector2D(X * NoiseScale + 0.1, Y * NoiseScale + 0.1)) * ZMultiplier;
+			continue;
+		}
 
-			// Debug: display the height value in the viewport for inspection
-			GEngine->AddOnScreenDebugMessage(-1, 999.0f, FColor::Yellow, FString::Printf(TEXT("Z: %f"), Z));
+		// Levels are generated on first use and kept for the next time the chunk switches back
+		EnsureChunkLOD(Chunk, LOD);
 
-			// Add the vertex and corresponding UV coordinate
-			Vertices.Add(FVector(X * Scale, Y * Scale, Z));
-			UV0.Add(FVector2D(X * UVScale, Y * UVScale));
+		// The index buffer differs between levels, so the section is re-created rather than updated
+		Chunk.CurrentLOD = LOD;
+		UploadChunk(Chunk, true);
+		ReleaseChunkBuffers(Chunk);
+	}
+}
+
+// Every player pawn is a focus, so a dedicated server streams collision around all clients
+void APerlinProcTerrain::GetStreamingFocusPoints(TArray<FVector, TInlineAllocator<4>>& OutPoints) const
+{
+	OutPoints.Reset();
+
+	const UWorld* World = GetWorld();
+	if (!World)
+	{
+		return;
+	}
+
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		const APawn* Pawn = PlayerController ? PlayerController->GetPawn() : nullptr;
+		if (Pawn)
+		{
+			OutPoints.Add(Pawn->GetActorLocation() - GetActorLocation());
 		}
 	}
 }
 
-// Creates triangle indices for connecting the grid vertices into a mesh surface
-void APerlinProcTerrain::CreateTriangles()
+// Ring streaming: far chunks go back to the pool first, then the nearest missing chunks are built
+void APerlinProcTerrain::UpdateStreaming()
 {
-	int Vertex = 0;
+	TRACE_CPUPROFILER_EVENT_SCOPE(APerlinProcTerrain::UpdateStreaming);
+
+	TArray<FVector, TInlineAllocator<4>> FocusPoints;
+	GetStreamingFocusPoints(FocusPoints);
+	if (FocusPoints.Num() == 0 || Scale <= 0.f)
+	{
+		return;
+	}
+
+	const int32 QuadsPerChunk = FMath::Max(1, ChunkSize);
+	const double ChunkWorldSize = double(QuadsPerChunk) * Scale;
+
+	TArray<FIntPoint, TInlineAllocator<4>> FocusChunks;
+	for (const FVector& Point : FocusPoints)
+	{
+		FocusChunks.Add(FIntPoint(FMath::FloorToInt(Point.X / ChunkWorldSize), FMath::FloorToInt(Point.Y / ChunkWorldSize)));
+	}
+
+	// Squared distance, in chunks, from a chunk to the nearest focus
+	auto GetDistanceSquared = [&FocusChunks](const FIntPoint& Coord)
+	{
+		int32 Best = MAX_int32;
+		for (const FIntPoint& Focus : FocusChunks)
+		{
+			const FIntPoint Delta = Coord - Focus;
+			Best = FMath::Min(Best, Delta.X * Delta.X + Delta.Y * Delta.Y);
+		}
+		return Best;
+	};
+
+	// Unload one ring further out than we load, so chunks on the boundary do not thrash
+	const int32 UnloadRadius = StreamingRadius + 1;
+	for (auto It = StreamedChunks.CreateIterator(); It; ++It)
+	{
+		if (GetDistanceSquared(It.Key()) > UnloadRadius * UnloadRadius)
+		{
+			RecycleStreamedChunk(MoveTemp(It.Value()));
+			It.RemoveCurrent();
+		}
+	}
+
+	// Coarse chunks must still start on a full-resolution vertex, so the step has to divide the chunk size
+	const int32 MaxStreamedLOD = bEnableLOD ? FMath::Min(MaxLOD, int32(FMath::CountTrailingZeros(uint32(QuadsPerChunk)))) : 0;
+
+	// Level of detail from the nearest focus, measured to the nearest point of the chunk like the fixed grid does
+	auto GetDesiredLOD = [this, &FocusPoints, ChunkWorldSize, MaxStreamedLOD](const FIntPoint& Coord)
+	{
+		if (MaxStreamedLOD == 0)
+		{
+			return 0;
+		}
+
+		const FBox2D Bounds(FVector2D(Coord) * ChunkWorldSize, FVector2D(Coord + FIntPoint(1, 1)) * ChunkWorldSize);
+		double BestSquared = MAX_dbl;
+		for (const FVector& Point : FocusPoints)
+		{
+			BestSquared = FMath::Min(BestSquared, Bounds.ComputeSquaredDistanceToPoint(FVector2D(Point)));
+		}
+		return FMath::Min(GetLODForDistance(float(FMath::Sqrt(BestSquared))), MaxStreamedLOD);
+	};
+
+	// Missing chunks inside the radius of any focus, and resident ones now at the wrong level, nearest first
+	TArray<TPair<int32, FIntPoint>> Missing;
+	for (const FIntPoint& Focus : FocusChunks)
+	{
+		for (int32 DX = -StreamingRadius; DX <= StreamingRadius; DX++)
+		{
+			for (int32 DY = -StreamingRadius; DY <= StreamingRadius; DY++)
+			{
+				const FIntPoint Coord = Focus + FIntPoint(DX, DY);
+				if (DX * DX + DY * DY <= StreamingRadius * StreamingRadius && !StreamedChunks.Contains(Coord))
+				{
+					Missing.AddUnique(TPair<int32, FIntPoint>(GetDistanceSquared(Coord), Coord));
+				}
+			}
+		}
+	}
+
+	for (const TPair<FIntPoint, TUniquePtr<FTerrainStreamedChunk>>& Pair : StreamedChunks)
+	{
+		if (Pair.Value->LOD != GetDesiredLOD(Pair.Key))
+		{
+			Missing.Add(TPair<int32, FIntPoint>(GetDistanceSquared(Pair.Key), Pair.Key));
+		}
+	}
+
+	if (Missing.Num() == 0)
+	{
+		return;
+	}
+
+	Missing.Sort([](const TPair<int32, FIntPoint>& A, const TPair<int32, FIntPoint>& B) { return A.Key < B.Key; });
 
-	for (int X = 0; X < XSize; X++)
+	const FTerrainBuildParams Params = GetBuildParams();
+	const TSharedRef<const FTerrainNoiseTable, ESPMode::ThreadSafe> Table = GetNoiseTable();
+	const double StartTime = FPlatformTime::Seconds();
+
+	int32 NumBuilt = 0;
+
+	for (const TPair<int32, FIntPoint>& Entry : Missing)
 	{
-		for (int Y = 0; Y < YSize; Y++)
+		// Always make progress, then stop once this frame's budget is spent
+		if (NumBuilt > 0 && (FPlatformTime::Seconds() - StartTime) * 1000.0 >= StreamingBudgetMs)
 		{
-			// Define two triangles for each quad in the grid
-			Triangles.Add(Vertex);
-			Triangles.Add(Vertex + 1);
-			Triangles.Add(Vertex + YSize + 1);
+			break;
+		}
 
-			Triangles.Add(Vertex + 1);
-			Triangles.Add(Vertex + YSize + 2);
-			Triangles.Add(Vertex + YSize + 1);
+		// A resident chunk changing level is regenerated in place and keeps its section
+		TUniquePtr<FTerrainStreamedChunk> Chunk;
+		if (TUniquePtr<FTerrainStreamedChunk>* Resident = StreamedChunks.Find(Entry.Value))
+		{
+			Chunk = MoveTemp(*Resident);
+		}
+		else if (StreamedChunkPool.Num() > 0)
+		{
+			Chunk = StreamedChunkPool.Pop(EAllowShrinking::No);
+		}
 
-			Vertex++;
+		int32 SectionIndex = Chunk.IsValid() && Chunk->Data.Chunks.Num() > 0 ? Chunk->Data.Chunks[0].SectionIndex : INDEX_NONE;
+		if (!Chunk.IsValid())
+		{
+			Chunk = MakeUnique<FTerrainStreamedChunk>();
 		}
+		if (SectionIndex == INDEX_NONE)
+		{
+			SectionIndex = NextStreamedSection++;
+		}
+
+		Chunk->Coord = Entry.Value;
+		Chunk->LOD = GetDesiredLOD(Entry.Value);
+		Chunk->Data.Params = Params;
+		TerrainBuild::BuildStreamedChunk(Chunk->Data, *Table, Entry.Value, SectionIndex, Chunk->LOD, OctaveCullCycles);
+
+		UploadChunk(Chunk->Data.Chunks[0], true);
+		ProcMesh->SetMaterial(SectionIndex, Mat);
 
-		// Skip to the next row of vertices
-		Vertex++;
+		StreamedChunks.Add(Entry.Value, MoveTemp(Chunk));
+		NumBuilt++;
 	}
 }
 
+// The section is cleared so it drops its render data and collision; its index is reused later
+void APerlinProcTerrain::RecycleStreamedChunk(TUniquePtr<FTerrainStreamedChunk>&& Chunk)
+{
+	if (!Chunk.IsValid())
+	{
+		return;
+	}
+
+	if (Chunk->Data.Chunks.Num() > 0)
+	{
+		ProcMesh->ClearMeshSection(Chunk->Data.Chunks[0].SectionIndex);
+	}
+
+	StreamedChunkPool.Add(MoveTemp(Chunk));
+}
 
+// Rebuilds the terrain and all of its chunk sections from the current parameters
 void APerlinProcTerrain::Regenerate()
 {
 	BuildMesh();
 }
-
+// Stores new generation parameters; Regenerate applies them
 void APerlinProcTerrain::SetTerrainParams(int32 InSeed, int32 InXVerts, int32 InYVerts, float InGridSpacing, float InHeightScale,
 	int32 InOctaves, float InFrequency, float InLacunarity, float InPersistence, bool bInRidge, bool bInBillow)
 {
 	Seed = InSeed;
 	XSize = InXVerts; // if user used XSize/YSize naming
 	YSize = InYVerts;
-	GridSpacing = InGridSpacing;
-	HeightScale = InHeightScale;
+	Scale = InGridSpacing;
+	ZMultiplier = InHeightScale;
 	Octaves = FMath::Clamp(InOctaves, 1, 12);
 	Frequency = FMath::Max(0.0001f, InFrequency);
 	Lacunarity = FMath::Max(1.f, InLacunarity);
 	Persistence = FMath::Clamp(InPersistence, 0.f, 1.f);
 	bRidge = bInRidge;
 	bBillow = bInBillow;
+
+	// Restart an in-flight build so it does not finish with stale parameters
+	if (IsBuilding())
+	{
+		BuildMesh();
+	}
 }
 
 
-float APerlinProcTerrain::FractalNoise2D(float X, float Y) const
+// Gathers the fractal noise controls into the settings the noise kernels take
+FTerrainNoiseSettings APerlinProcTerrain::GetNoiseSettings() const
+{
+	FTerrainNoiseSettings Settings;
+	Settings.Seed = Seed;
+	Settings.Type = NoiseType;
+	Settings.Octaves = Octaves;
+	Settings.Frequency = Frequency;
+	Settings.Lacunarity = Lacunarity;
+	Settings.Persistence = Persistence;
+	Settings.bRidge = bRidge;
+	Settings.bBillow = bBillow;
+	return Settings;
+}
+
+// Fetches the shared tables for Seed once; every sample of a build then reuses them
+TSharedRef<const FTerrainNoiseTable, ESPMode::ThreadSafe> APerlinProcTerrain::GetNoiseTable()
 {
-	float Amp = 1.f, Freq = Frequency, Sum = 0.f, Norm = 0.f;
-	for (int32 Oct=0; Oct<Octaves; ++Oct)
+	if (!NoiseTable.IsValid() || NoiseTable->GetSeed() != Seed)
 	{
-		float Sample = FMath::PerlinNoise3D(FVector(X*Freq, Y*Freq, Seed*0.1234f));
-		float N = Sample;
-		if (bRidge) { N = 1.f - FMath::Abs(Sample); }
-		else if (bBillow) { N = FMath::Abs(Sample); }
-		Sum += N * Amp; Norm += Amp; Amp *= Persistence; Freq *= Lacunarity;
+		NoiseTable = TerrainNoise::GetTable(Seed);
 	}
-	return (Norm>KINDA_SMALL_NUMBER) ? (Sum/Norm) : 0.f;
+	return NoiseTable.ToSharedRef();
+}
+
+// Single-sample fractal noise; GenerateHeights uses the batch row kernel instead
+float APerlinProcTerrain::FractalNoise2D(float X, float Y) const
+{
+	// Fall back to the shared cache when the tables have not been fetched for this seed yet
+	const TSharedRef<const FTerrainNoiseTable, ESPMode::ThreadSafe> Table =
+		(NoiseTable.IsValid() && NoiseTable->GetSeed() == Seed) ? NoiseTable.ToSharedRef() : TerrainNoise::GetTable(Seed);
+	return TerrainNoise::Fractal2D(*Table, GetNoiseSettings(), X, Y);
 }
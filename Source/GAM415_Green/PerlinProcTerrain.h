@@ -4,23 +4,183 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Engine/NetSerialization.h"
+#include "Containers/Ticker.h"
+#include "TerrainNoise.h"
+#include "TerrainBuild.h"
+#include "TerrainDeformJournal.h"
 #include "PerlinProcTerrain.generated.h"
 
 // Forward declarations to reduce include dependencies
 class UProceduralMeshComponent;   // Used to generate terrain mesh at runtime
 class UMaterialInterface;         // Base material for rendering the generated mesh
+class UTerrainHeightFieldComponent; // Height-field collision for the fixed grid
+class UStaticMesh;                // Tiles written by the bake commandlet
+class UStaticMeshComponent;       // Shows the baked tiles
+class FTerrainOctaveCache;        // Octave layers reused between editor preview builds
+class APerlinProcTerrain;
+
+// Broadcast on the game thread once a build has been applied to the mesh
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnTerrainBuilt, APerlinProcTerrain*, Terrain);
+
+// Broadcast on the game thread after each upload step of a build, with Progress in (0, 1]
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnTerrainBuildProgress, APerlinProcTerrain*, Terrain, float, Progress);
+
+/**
+ * FTerrainDeformStats
+ *
+ * Summary of the work a single AlterMesh call performed.
+ */
+USTRUCT(BlueprintType)
+struct FTerrainDeformStats
+{
+	GENERATED_BODY()
+
+	// Number of grid vertices displaced by the impact
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category="Terrain|Deformation")
+	int32 VerticesTouched = 0;
+
+	// Number of mesh sections re-uploaded for the impact
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category="Terrain|Deformation")
+	int32 SectionsUpdated = 0;
+
+	// Wall time spent in the deformation, in milliseconds
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category="Terrain|Deformation")
+	float Milliseconds = 0.f;
+};
+
+/**
+ * FTerrainDeformRequest
+ *
+ * An impact waiting in the deformation queue, captured with the crater settings at the time.
+ */
+struct FTerrainDeformRequest
+{
+	// Impact point relative to the actor
+	FVector LocalCenter = FVector::ZeroVector;
+
+	// Crater radius
+	float Radius = 0.f;
+
+	// Displacement subtracted from every vertex inside the crater
+	FVector Offset = FVector::ZeroVector;
+
+	// Grid rectangle the crater can touch, used to merge overlapping impacts. Worked out once when
+	// the impact is queued, or on the first drain if no grid was built yet.
+	FIntRect Footprint;
+	bool bHasFootprint = false;
+};
+
+/**
+ * FTerrainDeformEvent
+ *
+ * One deformation as sent from the server to clients. The impact point is relative to the actor
+ * and rounded to whole units, and the crater size is an index into the terrain's radius classes,
+ * so a typical event packs into around eight bytes.
+ */
+USTRUCT()
+struct FTerrainDeformEvent
+{
+	GENERATED_BODY()
+
+	// Server-assigned order of the event; clients skip anything they have already applied
+	UPROPERTY()
+	uint32 Sequence = 0;
+
+	// Impact point relative to the actor
+	UPROPERTY()
+	FVector_NetQuantize LocalCenter = FVector::ZeroVector;
+
+	// Index into APerlinProcTerrain::RadiusClasses
+	UPROPERTY()
+	uint8 RadiusClass = 0;
+
+	// Packs the sequence number, the quantized position and a 4-bit radius class
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FTerrainDeformEvent> : public TStructOpsTypeTraitsBase2<FTerrainDeformEvent>
+{
+	enum { WithNetSerializer = true };
+};
+
+/**
+ * FTerrainDeformSnapshot
+ *
+ * Deformation state sent once to clients that join after craters have been made: the server's
+ * compressed deformation journal, plus the events applied since the journal was last captured.
+ */
+USTRUCT()
+struct FTerrainDeformSnapshot
+{
+	GENERATED_BODY()
+
+	// Sequence number of the last event the journal includes
+	UPROPERTY()
+	uint32 Sequence = 0;
+
+	// Compressed FTerrainDeformJournal bytes
+	UPROPERTY()
+	TArray<uint8> Journal;
+
+	// Events after Sequence, oldest first
+	UPROPERTY()
+	TArray<FTerrainDeformEvent> Tail;
+};
+
+/**
+ * FTerrainDeformEventOrder
+ *
+ * Releases deformation events strictly in sequence order. A client can receive an event twice (in a
+ * late-join snapshot's tail and again in a multicast) or ahead of an earlier one, so duplicates are
+ * dropped and events past a gap are held until the gap fills.
+ */
+struct FTerrainDeformEventOrder
+{
+	// Sequence number of the newest event released
+	uint32 LastSequence = 0;
+
+	// Events received ahead of a gap, oldest first
+	TArray<FTerrainDeformEvent> Held;
+
+	// Takes an event and appends every event now in order to OutReady. Returns false if the event
+	// was released or held already.
+	bool Receive(const FTerrainDeformEvent& Event, TArray<FTerrainDeformEvent>& OutReady);
+
+	// Treats every event up to Sequence as released, e.g. once a snapshot's journal is loaded, and
+	// appends any held events that are now in order to OutReady
+	void SkipTo(uint32 Sequence, TArray<FTerrainDeformEvent>& OutReady);
+
+private:
+	// Moves held events that directly follow LastSequence to OutReady
+	void ReleaseHeld(TArray<FTerrainDeformEvent>& OutReady);
+};
 
 /**
  * APerlinProcTerrain
  *
  * Actor that generates a grid-based procedural terrain mesh using Perlin noise for height data.
- * Supports runtime deformation through mesh updates based on impact points.
+ * The grid is split into fixed-size chunks, each uploaded as its own mesh section, so runtime
+ * deformation only re-uploads the chunks an impact actually touches. Generation can run on
+ * worker tasks (bAsyncBuild), in which case the result is applied on the game thread later.
+ * In multiplayer the server assigns every queued impact a sequence number and multicasts it as
+ * a compact event; clients queue the events and apply them through the same batched path.
  */
 UCLASS()
 class GAM415_GREEN_API APerlinProcTerrain : public AActor
 {
 	GENERATED_BODY()
 
+	// Sets the protected noise controls for each benchmark case
+	friend class UTerrainBenchmarkCommandlet;
+
+	// Reads the build parameters and writes the baked tile list
+	friend class UTerrainBakeCommandlet;
+
+	// Drives a server and a late-joining client terrain through the replication path
+	friend class FTerrainDeformLateJoinTest;
+
 public:
 	// Sets default values for this actor's properties
 	APerlinProcTerrain();
@@ -49,6 +209,93 @@ public:
 	UPROPERTY(EditAnywhere, Meta = (ClampMin = 0.000001))
 	float UVScale = 0;
 
+	// Number of grid quads along each side of a chunk; every chunk is its own mesh section
+	UPROPERTY(EditAnywhere, Category="Terrain|Chunks", Meta = (ClampMin = 1))
+	int32 ChunkSize = 64;
+
+	// Prints every generated height as an on-screen debug message (slow; allocates a string per vertex)
+	UPROPERTY(EditAnywhere, Category="Terrain|Debug")
+	bool bShowDebugHeights = false;
+
+	// Generates the terrain on worker tasks and applies it when ready instead of blocking BeginPlay
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Terrain|Build")
+	bool bAsyncBuild = false;
+
+	// Picks a level of detail per chunk from its distance to the player's view
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Terrain|LOD")
+	bool bEnableLOD = false;
+
+	// Distance at which chunks drop to LOD 1; each further level starts at twice the previous distance
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Terrain|LOD", Meta = (ClampMin = 0, EditCondition = "bEnableLOD"))
+	float LODDistance = 5000.f;
+
+	// Coarsest level of detail; level N samples every (1 << N)th grid vertex
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Terrain|LOD", Meta = (ClampMin = 0, ClampMax = 6, EditCondition = "bEnableLOD"))
+	int32 MaxLOD = 4;
+
+	// Depth of the skirt hung below every chunk border to hide cracks between levels of detail
+	UPROPERTY(EditAnywhere, Category="Terrain|LOD", Meta = (ClampMin = 0, EditCondition = "bEnableLOD"))
+	float SkirtDepth = 200.f;
+
+	// Backs collision with a Chaos height field instead of cooking a triangle mesh per chunk.
+	// Deformation patches the changed cells in place. Streamed chunks keep trimesh collision.
+	UPROPERTY(EditAnywhere, Category="Terrain|Collision")
+	bool bHeightFieldCollision = false;
+
+	// Grid vertices per height field sample; 2 or more trades collision precision for memory. Lowered
+	// per axis to the nearest step that divides XSize or YSize, so collision ends at the mesh edge.
+	UPROPERTY(EditAnywhere, Category="Terrain|Collision", Meta = (ClampMin = 1, EditCondition = "bHeightFieldCollision"))
+	int32 CollisionStep = 1;
+
+	// Generates chunks in rings around every player instead of one fixed XSize x YSize grid, and
+	// recycles chunks that fall out of range. XSize, YSize and deformation are unused in this mode.
+	// With bEnableLOD, distant chunks are generated at their level's coarser spacing.
+	UPROPERTY(EditAnywhere, Category="Terrain|Streaming")
+	bool bStreaming = false;
+
+	// Chunks within this many chunk widths of a player are generated
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Terrain|Streaming", Meta = (ClampMin = 1, EditCondition = "bStreaming"))
+	int32 StreamingRadius = 6;
+
+	// Game-thread time spent generating chunks per frame; at least one chunk is generated regardless
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Terrain|Streaming", Meta = (ClampMin = 0, EditCondition = "bStreaming"))
+	float StreamingBudgetMs = 2.f;
+
+	// Coarse streamed chunks skip fractal octaves finer than this many noise cycles per vertex spacing.
+	// 0.5 is the Nyquist limit: a grid can only represent detail up to half a cycle per vertex, and
+	// finer octaves only alias into false bumps. Lower values cull harder. Full-resolution chunks
+	// always evaluate every octave. 0 disables culling.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Terrain|Streaming", Meta = (ClampMin = 0, EditCondition = "bStreaming && bEnableLOD"))
+	float OctaveCullCycles = 0.5f;
+
+	// Loads heights from Saved/TerrainCache when a terrain with identical generation parameters was built
+	// before, and stores freshly generated heights there for the next run
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Terrain|Build")
+	bool bUseHeightCache = false;
+
+	// Fired on the game thread whenever a build, synchronous or asynchronous, has been applied
+	UPROPERTY(BlueprintAssignable, Category="Terrain|Build")
+	FOnTerrainBuilt OnTerrainBuilt;
+
+	// Fired after every section or collision step of a build is applied on the game thread
+	UPROPERTY(BlueprintAssignable, Category="Terrain|Build")
+	FOnTerrainBuildProgress OnTerrainBuildProgress;
+
+	// Game-thread time per frame spent creating sections and collision for a finished build.
+	// 0 applies the whole build at once. At least one chunk is uploaded per frame regardless.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Terrain|Build", Meta = (ClampMin = 0))
+	float UploadBudgetMs = 0.f;
+
+#if WITH_EDITORONLY_DATA
+	// Rebuilds the terrain in the level editor shortly after a generation property is edited
+	UPROPERTY(EditAnywhere, Category="Terrain|Editor")
+	bool bLivePreview = true;
+
+	// Seconds without further edits before the preview rebuilds, so dragging a slider builds once it settles
+	UPROPERTY(EditAnywhere, Category="Terrain|Editor", Meta = (ClampMin = 0, EditCondition = "bLivePreview"))
+	float PreviewRebuildDelay = 0.25f;
+#endif
+
 	// Radius of influence for mesh deformation (used in AlterMesh)
 	UPROPERTY(EditAnywhere)
 	float radius;
@@ -57,15 +304,79 @@ public:
 	UPROPERTY(EditAnywhere)
 	FVector Depth;
 
+	// Keeps each chunk's vertex buffers after upload so impacts can refill them. When off, the buffers
+	// are released once the section is created and AlterMesh and QueueDeformation do nothing.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Terrain|Deformation")
+	bool bDeformable = true;
+
+	// Shows the tiles written by the TerrainBake commandlet instead of generating the terrain. Baked
+	// terrain is static: deformation is disabled and the height queries find nothing.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Terrain|Baked")
+	bool bUseBakedTiles = false;
+
+	// Static mesh tiles, one per chunk, assigned by the TerrainBake commandlet
+	UPROPERTY(VisibleAnywhere, Category="Terrain|Baked")
+	TArray<TSoftObjectPtr<UStaticMesh>> BakedTiles;
+
+	// Writes material splat weights into the vertex colors: R grass, G rock (by slope), B snow (by height)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Terrain|Splat")
+	bool bSplatColors = false;
+
+	// Slope in degrees from flat where grass starts blending into rock, and where it is fully rock
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Terrain|Splat", Meta = (ClampMin = 0, ClampMax = 90, EditCondition = "bSplatColors"))
+	float RockSlopeStart = 30.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Terrain|Splat", Meta = (ClampMin = 0, ClampMax = 90, EditCondition = "bSplatColors"))
+	float RockSlopeEnd = 45.f;
+
+	// Actor-space height of the snow line, and the height band either side of it that blends to snow
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Terrain|Splat", Meta = (EditCondition = "bSplatColors"))
+	float SnowHeight = 500.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Terrain|Splat", Meta = (ClampMin = 0, EditCondition = "bSplatColors"))
+	float SnowBlend = 100.f;
+
+	// Stores one 16-bit height per grid point instead of a float, halving height memory at a precision
+	// of (max - min height) / 65535
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Terrain|Memory")
+	bool bQuantizeHeights = false;
+
 protected:
 	float FractalNoise2D(float X, float Y) const;
+
+	// Generates the grid and (re)creates one mesh section per chunk
 	void BuildMesh();
+
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	// Abandons any asynchronous build still in flight
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Registers the late-join deformation snapshot
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+#if WITH_EDITOR
+	// Schedules a preview rebuild when a generation property changes in the level editor
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+
+	// Drops a preview rebuild that has not fired yet
+	virtual void BeginDestroy() override;
+
+	// Keeps the preview mesh out of the saved level and rebuilds it once the save is done
+	virtual void PreSave(FObjectPreSaveContext SaveContext) override;
+#endif
+
 	// Material to apply to the procedural mesh
-	
+
 	// === Added: Fractal noise controls ===
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Terrain|Noise")
+	int32 Seed = 1337;
+
+	// Seeded 2D basis summed by the fractal noise
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Terrain|Noise")
+	ETerrainNoiseType NoiseType = ETerrainNoiseType::Perlin;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Terrain|Noise", meta=(ClampMin="1", ClampMax="12"))
 	int32 Octaves = 5;
 
@@ -83,6 +394,10 @@ protected:
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Terrain|Noise")
 	bool bBillow = false;
+
+	// Builds heights from the fractal controls above (batch SIMD kernel) instead of single-octave NoiseScale noise
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Terrain|Noise")
+	bool bUseFractalNoise = false;
 UPROPERTY(EditAnywhere)
 	UMaterialInterface* Mat;
 
@@ -90,38 +405,285 @@ public:
 	// Called every frame (disabled in constructor, but implemented for flexibility)
 	virtual void Tick(float DeltaTime) override;
 
-	// Alters the mesh at runtime by displacing vertices near an impact point
+	// Alters the mesh at runtime by displacing vertices near an impact point. Applies immediately on
+	// this machine only; use QueueDeformation for craters that replicate.
 	UFUNCTION()
-	void AlterMesh(FVector impactPoint);
+	FTerrainDeformStats AlterMesh(FVector impactPoint);
+
+	// Stats reported by the most recent AlterMesh call or queued deformation batch
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category="Terrain|Deformation")
+	FTerrainDeformStats LastDeformStats;
+
+	// Queues an impact; Tick merges overlapping craters and applies them within DeformationBudgetMs.
+	// Only the server (or a standalone game) accepts impacts; clients receive them as events, and send
+	// their own through AGAM415_GreenCharacter::ServerQueueDeformation.
+	UFUNCTION(BlueprintCallable, Category="Terrain|Deformation")
+	void QueueDeformation(FVector ImpactPoint);
+
+	// Game-thread time spent applying queued deformations per frame; at least one batch always runs
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Terrain|Deformation", Meta = (ClampMin = 0))
+	float DeformationBudgetMs = 1.f;
+
+	// Number of impacts waiting in the deformation queue
+	int32 GetNumQueuedDeformations() const { return PendingDeformations.Num(); }
+
+	// Crater radii impacts are snapped to for replication, at most 16; empty uses radius alone
+	UPROPERTY(EditAnywhere, Category="Terrain|Replication")
+	TArray<float> RadiusClasses;
+
+	// Events captured in the late-join snapshot's tail before the journal is compressed again
+	UPROPERTY(EditAnywhere, Category="Terrain|Replication", Meta = (ClampMin = 1))
+	int32 SnapshotTailLength = 32;
+
+	// Sequence number of the newest deformation event this terrain has queued
+	UFUNCTION(BlueprintPure, Category="Terrain|Replication")
+	int64 GetLastDeformSequence() const { return DeformEventOrder.LastSequence; }
+
+	// Writes the net height change of every deformed vertex, for a save game or similar
+	UFUNCTION(BlueprintCallable, Category="Terrain|Deformation")
+	void SaveDeformations(TArray<uint8>& OutBytes) const;
+
+	// Replaces the current deformations with ones written by SaveDeformations, in one batched
+	// refresh. While a build is pending the bytes are held and applied when it finishes. Returns
+	// false if they were recorded on a terrain generated from different parameters. On a server,
+	// load before clients connect; connected clients only receive new events.
+	UFUNCTION(BlueprintCallable, Category="Terrain|Deformation")
+	bool LoadDeformations(const TArray<uint8>& Bytes);
+
+	// Number of grid vertices with a recorded height change
+	int32 GetNumJournaledVertices() const { return DeformJournal.Num(); }
+
+	// Running total of vertices sent to mesh sections since the actor was created
+	int64 GetNumUploadedVertices() const { return NumUploadedVertices; }
+
+	// Bytes the terrain keeps on the CPU for its grid: heights, chunk buffers and the deformation journal
+	SIZE_T GetAllocatedGridSize() const { return Grid.GetAllocatedSize() + DeformJournal.GetAllocatedSize(); }
+
+	// Rebuilds the whole terrain from the current parameters (in the background when used from the editor)
+	UFUNCTION(BlueprintCallable, CallInEditor, Category="Terrain")
+	void Regenerate();
+
+	// === Grid queries ===
+	// The grid is regular (X * Scale, Y * Scale) in actor space, so these answer directly from
+	// the grid index and stored heights. Only heights are stored, so lateral offsets in Depth are ignored.
+
+	// Inclusive grid rectangle of vertices that can lie within InRadius of a local-space point.
+	// Returns an empty rectangle (Min > Max) when the circle misses the grid entirely.
+	FIntRect GetVertexRangeInRadius(const FVector& LocalCenter, float InRadius) const;
+
+	// Index into the vertex grid of the vertex closest to a world location, or INDEX_NONE if the
+	// location is outside the terrain footprint
+	UFUNCTION(BlueprintCallable, Category="Terrain|Query")
+	int32 FindNearestVertex(FVector WorldLocation) const;
+
+	// Bilinearly interpolated local-space height at a local-space XY position
+	bool GetHeightBilinear(const FVector2D& LocalXY, float& OutZ) const;
+
+	// World-space ground height below (or above) a world location, from the stored heights rather
+	// than a trace. Reflects every applied deformation. Returns false off the terrain.
+	UFUNCTION(BlueprintCallable, Category="Terrain|Query")
+	bool GetHeightAtLocation(FVector WorldLocation, float& OutHeight) const;
+
+	// Surface normal of the terrain at a world location's XY. Returns false off the terrain.
+	UFUNCTION(BlueprintCallable, Category="Terrain|Query")
+	bool GetNormalAtLocation(FVector WorldLocation, FVector& OutNormal) const;
+
+	// Batch form of the two queries above: the ground point and normal below each location.
+	// Locations off the terrain get OutHits false. Returns the number of hits.
+	UFUNCTION(BlueprintCallable, Category="Terrain|Query")
+	int32 GetSurfaceAtLocations(const TArray<FVector>& WorldLocations, TArray<FVector>& OutPoints, TArray<FVector>& OutNormals, TArray<bool>& OutHits) const;
+
+	// True while an asynchronous build is running or its sections are still being uploaded; the mesh is hidden until it is done
+	UFUNCTION(BlueprintPure, Category="Terrain|Build")
+	bool IsBuilding() const { return PendingBuild.IsValid() || NextUploadStep != INDEX_NONE; }
+
+	// Abandons the asynchronous build in flight, if any, leaving the terrain hidden
+	UFUNCTION(BlueprintCallable, Category="Terrain|Build")
+	void CancelBuild();
+
+	// Sets all generation parameters at once; call Regenerate to apply them.
+	// An asynchronous build already in flight is restarted with the new parameters.
+	UFUNCTION(BlueprintCallable, Category="Terrain")
+	void SetTerrainParams(int32 InSeed, int32 InXVerts, int32 InYVerts, float InGridSpacing, float InHeightScale,
+		int32 InOctaves, float InFrequency, float InLacunarity, float InPersistence, bool bInRidge, bool bInBillow);
 
 private:
 	// Runtime-generated mesh component
 	UProceduralMeshComponent* ProcMesh;
 
-	// Stores vertex positions for the terrain mesh
-	TArray<FVector> Vertices;
+	// Height-field collision used instead of section collision when bHeightFieldCollision is set
+	UPROPERTY(VisibleAnywhere, Category="Terrain|Collision")
+	UTerrainHeightFieldComponent* HeightFieldCollision;
+
+	// One component per baked tile while bUseBakedTiles is in effect
+	UPROPERTY(Transient)
+	TArray<UStaticMeshComponent*> BakedTileComponents;
+
+	// True if the terrain shows baked tiles instead of generating (streaming terrains always generate)
+	bool UsesBakedTiles() const { return bUseBakedTiles && BakedTiles.Num() > 0 && !bStreaming; }
+
+	// Replaces the tile components with ones for the current BakedTiles
+	void LoadBakedTiles();
+
+	// True if mesh sections cook their own collision rather than leaving it to the height field
+	bool UsesSectionCollision() const { return !bHeightFieldCollision || bStreaming; }
+
+	// The applied build: grid heights plus per-chunk section buffers
+	FTerrainBuildData Grid;
+
+	// Streamed chunks currently resident, by chunk coordinate
+	TMap<FIntPoint, TUniquePtr<FTerrainStreamedChunk>> StreamedChunks;
+
+	// Unloaded chunks kept for reuse with their section index and buffers
+	TArray<TUniquePtr<FTerrainStreamedChunk>> StreamedChunkPool;
+
+	// Next mesh section index handed to a streamed chunk when the pool is empty
+	int32 NextStreamedSection = 0;
+
+	// Asynchronous build in flight, if any
+	TSharedPtr<FTerrainBuildJob, ESPMode::ThreadSafe> PendingBuild;
+
+	// Snapshot of the properties generation reads
+	FTerrainBuildParams GetBuildParams() const;
+
+	// Replaces the current mesh with a finished build and notifies listeners
+	void ApplyBuild(FTerrainBuildData&& Data);
+
+	// Hides the mesh and its collision while a build is in flight
+	void SetBuildingState(bool bBuilding);
+
+	// True in level editor worlds, where the terrain is only ever a preview of its parameters
+	bool IsPreviewWorld() const;
+
+	// Octave layers kept between preview builds; never created in game worlds
+	TSharedPtr<FTerrainOctaveCache, ESPMode::ThreadSafe> OctaveCache;
+
+#if WITH_EDITOR
+	// Restarts the preview rebuild delay
+	void SchedulePreviewRebuild();
+
+	FTSTicker::FDelegateHandle PreviewRebuildHandle;
+#endif
+
+	// Next upload step of the applied build, or INDEX_NONE once every step has run
+	int32 NextUploadStep = INDEX_NONE;
+
+	// Runs upload steps until BudgetMs is spent (0 = all of them)
+	void UploadPendingSteps(double BudgetMs);
+
+	// Builds collision, applies saved deformations, shows the terrain and notifies listeners
+	void FinishBuild();
+
+	// Height and optional normal at a local-space XY, from the fixed grid or the streamed chunk covering it
+	bool SampleSurface(const FVector2D& LocalXY, float& OutZ, FVector* OutNormal) const;
+
+	// Collects the grid index of every vertex inside the crater around LocalCenter
+	void CollectCraterVertices(const FVector& LocalCenter, float Radius, TArray<int32>& OutIndices) const;
+
+	// Displaces the collected vertices once and re-uploads each chunk they touch exactly once
+	int32 ApplyDeformation(TConstArrayView<int32> Indices, const FVector& Offset);
+
+	// Moves the listed vertices and returns the grid rectangle they span
+	FIntRect DisplaceVertices(TConstArrayView<int32> Indices, const FVector& Offset);
+
+	// Recomputes normals, collision and sections around moved vertices; returns sections updated
+	int32 RefreshDeformedRegion(const FIntRect& Moved);
+
+	// Impacts waiting to be applied, oldest first
+	TArray<FTerrainDeformRequest> PendingDeformations;
+
+	// Net height change of every vertex deformed since the grid was generated
+	FTerrainDeformJournal DeformJournal;
+
+	// Saved deformations waiting for the build in progress to finish
+	TArray<uint8> PendingJournal;
+
+	// Swaps the recorded deformations for a saved journal and refreshes the union of both areas
+	bool ApplyJournal(TConstArrayView<uint8> Bytes);
+
+	// === Replication ===
+
+	// Newest sequence number assigned (server) or queued (client), and events a client got out of order
+	FTerrainDeformEventOrder DeformEventOrder;
+
+	// Events queued on the server this frame, multicast together on the next Tick
+	TArray<FTerrainDeformEvent> OutgoingDeformEvents;
+
+	// Records outgoing events and the snapshot tail even without a net driver, so automation tests
+	// can drive the replication path in a transient world
+	bool bRecordDeformEventsStandalone = false;
+
+	// Late-join state; only sent with the actor's initial replication
+	UPROPERTY(ReplicatedUsing = OnRep_DeformSnapshot)
+	FTerrainDeformSnapshot DeformSnapshot;
+
+	// Queues a client's late-join state
+	UFUNCTION()
+	void OnRep_DeformSnapshot();
+
+	// Sends this frame's events to every client
+	UFUNCTION(NetMulticast, Reliable)
+	void MulticastDeformEvents(const TArray<FTerrainDeformEvent>& Events);
+
+	// Multicasts pending events and recaptures the snapshot once its tail is long and the queue is empty
+	void FlushDeformEvents();
+
+	// Compresses the current journal into the snapshot and clears its tail
+	void CaptureDeformSnapshot();
+
+	// Queues an event in the deformation queue, along with any held events it brings into order.
+	// Events queued already are ignored; events past a missing one wait for it.
+	void QueueDeformEvent(const FTerrainDeformEvent& Event);
+
+	// Adds released events to the deformation queue
+	void QueueOrderedDeformEvents(TConstArrayView<FTerrainDeformEvent> Events);
+
+	// Radius class closest to InRadius, and the radius a class stands for
+	uint8 GetRadiusClass(float InRadius) const;
+	float GetClassRadius(uint8 RadiusClass) const;
+
+	// Applies queued impacts in merged batches until BudgetMs is spent; returns batches applied
+	int32 DrainDeformations(double BudgetMs);
+
+	// Creates or updates the mesh section backing a chunk from its current level of detail
+	void UploadChunk(const FTerrainChunk& Chunk, bool bCreate);
+
+	// Vertices uploaded by UploadChunk so far
+	int64 NumUploadedVertices = 0;
+
+	// Generates a chunk's level of detail if its buffers are missing
+	void EnsureChunkLOD(FTerrainChunk& Chunk, int32 LOD);
+
+	// Drops a chunk's CPU vertex buffers after upload unless the terrain is deformable
+	void ReleaseChunkBuffers(FTerrainChunk& Chunk);
+
+	// Player view location relative to the actor; false if there is no local view (e.g. dedicated server)
+	bool GetLocalViewLocation(FVector& OutLocation) const;
+
+	// Level of detail a chunk should use when seen from a local-space view location
+	int32 SelectChunkLOD(const FTerrainChunk& Chunk, const FVector& LocalView) const;
 
-	// Stores triangle indices to define the mesh surface
-	TArray<int> Triangles;
+	// Level of detail for a horizontal distance to the nearest point of a chunk
+	int32 GetLODForDistance(float Distance) const;
 
-	// UV mapping coordinates for texturing the mesh
-	TArray<FVector2D> UV0;
+	// Switches chunks whose distance band has changed, generating missing levels on first use
+	void UpdateLODs();
 
-	// Stores normal vectors (can be calculated if needed)
-	TArray<FVector> Normals;
+	// Player pawn locations relative to the actor, used as streaming focus points
+	void GetStreamingFocusPoints(TArray<FVector, TInlineAllocator<4>>& OutPoints) const;
 
-	// Stores vertex colors (optional)
-	TArray<FColor> VertexColors;
+	// Unloads out-of-range streamed chunks and generates the nearest missing ones within budget
+	void UpdateStreaming();
 
-	// Used to store updated vertex colors after mesh alteration (if needed)
-	TArray<FColor> UpVertexColors;
+	// Clears a streamed chunk's section and returns it to the pool
+	void RecycleStreamedChunk(TUniquePtr<FTerrainStreamedChunk>&& Chunk);
 
-	// ID for the mesh section (allows for multiple sections if extended)
-	int sectionID = 0;
+	// Gathers the fractal noise controls into the settings the noise kernels take
+	FTerrainNoiseSettings GetNoiseSettings() const;
 
-	// Generates vertex positions and UVs using Perlin noise
-	void CreateVertices();
+	// Permutation/gradient tables for the current Seed, shared with other terrains using the same seed
+	TSharedPtr<const FTerrainNoiseTable, ESPMode::ThreadSafe> NoiseTable;
 
-	// Creates triangle indices from the vertex grid
-	void CreateTriangles();
+	// Returns NoiseTable, rebuilding it first if Seed has changed since it was fetched
+	TSharedRef<const FTerrainNoiseTable, ESPMode::ThreadSafe> GetNoiseTable();
 };
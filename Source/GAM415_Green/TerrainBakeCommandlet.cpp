@@ -0,0 +1,264 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TerrainBakeCommandlet.h"
+#include "PerlinProcTerrain.h"
+
+#if WITH_EDITOR
+#include "Async/ParallelFor.h"                   // Builds tile geometry on all cores
+#include "Engine/Level.h"                        // Actors of the loaded map
+#include "Engine/StaticMesh.h"                   // Baked tile assets
+#include "Engine/World.h"                        // World inside the map package
+#include "MeshDescription.h"                     // Source geometry of each tile LOD
+#include "Misc/PackageName.h"                    // Asset and map file names
+#include "PhysicsEngine/BodySetup.h"             // Complex-as-simple tile collision
+#include "StaticMeshAttributes.h"                // Position, normal, tangent, UV and color attributes
+#include "StaticMeshCompiler.h"                  // Waits for the batch build before saving
+#include "UObject/Package.h"                     // Tile packages
+#include "UObject/SavePackage.h"                 // Writing tiles and the map
+#include "ProfilingDebugging/CpuProfilerTrace.h" // Named CPU scopes for Unreal Insights
+
+namespace TerrainBake
+{
+	// Single material slot every tile uses
+	static const FName MaterialSlotName(TEXT("Terrain"));
+
+	// Converts one level of a chunk's section buffers into static mesh source geometry
+	static FMeshDescription MakeTileDescription(const FTerrainChunkMesh& Mesh)
+	{
+		FMeshDescription Description;
+		FStaticMeshAttributes Attributes(Description);
+		Attributes.Register();
+
+		TVertexAttributesRef<FVector3f> Positions = Attributes.GetVertexPositions();
+		TVertexInstanceAttributesRef<FVector3f> Normals = Attributes.GetVertexInstanceNormals();
+		TVertexInstanceAttributesRef<FVector3f> Tangents = Attributes.GetVertexInstanceTangents();
+		TVertexInstanceAttributesRef<float> BinormalSigns = Attributes.GetVertexInstanceBinormalSigns();
+		TVertexInstanceAttributesRef<FVector2f> UVs = Attributes.GetVertexInstanceUVs();
+		TVertexInstanceAttributesRef<FVector4f> Colors = Attributes.GetVertexInstanceColors();
+
+		const int32 NumVertices = Mesh.Vertices.Num();
+		const TArray<int32>& Triangles = *Mesh.Triangles;
+
+		Description.ReserveNewVertices(NumVertices);
+		Description.ReserveNewVertexInstances(NumVertices);
+		Description.ReserveNewTriangles(Triangles.Num() / 3);
+
+		const FPolygonGroupID Group = Description.CreatePolygonGroup();
+		Attributes.GetPolygonGroupMaterialSlotNames()[Group] = MaterialSlotName;
+
+		// Section vertices already carry their own normals, so each is one vertex with one instance
+		TArray<FVertexInstanceID> Instances;
+		Instances.SetNumUninitialized(NumVertices);
+		for (int32 i = 0; i < NumVertices; i++)
+		{
+			const FVertexID Vertex = Description.CreateVertex();
+			Positions[Vertex] = FVector3f(Mesh.Vertices[i]);
+
+			const FVertexInstanceID Instance = Description.CreateVertexInstance(Vertex);
+			Normals[Instance] = FVector3f(Mesh.Normals[i]);
+			Tangents[Instance] = FVector3f(Mesh.Tangents[i].TangentX);
+			BinormalSigns[Instance] = Mesh.Tangents[i].bFlipTangentY ? -1.f : 1.f;
+			UVs.Set(Instance, 0, FVector2f(Mesh.UV0[i]));
+			Colors[Instance] = Mesh.Colors.Num() > 0 ? FVector4f(FLinearColor(Mesh.Colors[i])) : FVector4f(1.f, 1.f, 1.f, 1.f);
+			Instances[i] = Instance;
+		}
+
+		for (int32 i = 0; i + 2 < Triangles.Num(); i += 3)
+		{
+			Description.CreateTriangle(Group, { Instances[Triangles[i]], Instances[Triangles[i + 1]], Instances[Triangles[i + 2]] });
+		}
+
+		return Description;
+	}
+
+	// Saves a package holding Asset as its only top-level object
+	static bool SaveAssetPackage(UPackage* Package, UObject* Asset, const FString& Extension)
+	{
+		const FString Filename = FPackageName::LongPackageNameToFilename(Package->GetName(), Extension);
+
+		FSavePackageArgs SaveArgs;
+		SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+		return UPackage::SavePackage(Package, Asset, *Filename, SaveArgs);
+	}
+}
+#endif
+
+UTerrainBakeCommandlet::UTerrainBakeCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UTerrainBakeCommandlet::Main(const FString& Params)
+{
+#if WITH_EDITOR
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	TMap<FString, FString> ParamsMap;
+	ParseCommandLine(*Params, Tokens, Switches, ParamsMap);
+
+	const FString* MapName = ParamsMap.Find(TEXT("Map"));
+	if (!MapName)
+	{
+		UE_LOG(LogTemp, Error, TEXT("TerrainBake: no map given; pass -Map=/Game/Path/To/Map"));
+		return 1;
+	}
+
+	const FString OutputPath = ParamsMap.Contains(TEXT("Output")) ? ParamsMap[TEXT("Output")] : TEXT("/Game/BakedTerrain");
+	const int32 NumLODs = ParamsMap.Contains(TEXT("LODs")) ? FCString::Atoi(*ParamsMap[TEXT("LODs")]) : 0;
+	const bool bEnable = Switches.Contains(TEXT("Enable"));
+
+	UPackage* MapPackage = LoadPackage(nullptr, **MapName, LOAD_None);
+	UWorld* World = MapPackage ? UWorld::FindWorldInPackage(MapPackage) : nullptr;
+	if (!World || !World->PersistentLevel)
+	{
+		UE_LOG(LogTemp, Error, TEXT("TerrainBake: could not load map %s"), **MapName);
+		return 1;
+	}
+
+	// Tiles of each map go in their own folder so terrains with the same name in different maps do not collide
+	const FString MapOutputPath = OutputPath / FPackageName::GetShortName(MapPackage);
+
+	int32 NumTerrains = 0;
+	int32 NumBaked = 0;
+	for (AActor* Actor : World->PersistentLevel->Actors)
+	{
+		APerlinProcTerrain* Terrain = Cast<APerlinProcTerrain>(Actor);
+		if (!Terrain)
+		{
+			continue;
+		}
+
+		NumTerrains++;
+		if (Terrain->bStreaming)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("TerrainBake: skipping %s, streaming terrains have no fixed extent to bake"), *Terrain->GetName());
+			continue;
+		}
+
+		if (BakeTerrain(Terrain, MapOutputPath, NumLODs))
+		{
+			if (bEnable)
+			{
+				Terrain->bUseBakedTiles = true;
+			}
+			NumBaked++;
+		}
+	}
+
+	if (NumBaked > 0 && !TerrainBake::SaveAssetPackage(MapPackage, World, FPackageName::GetMapPackageExtension()))
+	{
+		UE_LOG(LogTemp, Error, TEXT("TerrainBake: failed to save %s"), *MapPackage->GetName());
+		return 1;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("TerrainBake: baked %d of %d terrains in %s"), NumBaked, NumTerrains, **MapName);
+	return NumBaked == NumTerrains ? 0 : 1;
+#else
+	UE_LOG(LogTemp, Error, TEXT("TerrainBake: only available in editor builds"));
+	return 1;
+#endif
+}
+
+#if WITH_EDITOR
+bool UTerrainBakeCommandlet::BakeTerrain(APerlinProcTerrain* Terrain, const FString& OutputPath, int32 NumLODs)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UTerrainBakeCommandlet::BakeTerrain);
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	// Coarsest usable level still has one quad per chunk side
+	const int32 ChunkSize = FMath::Max(1, Terrain->ChunkSize);
+	NumLODs = FMath::Clamp(NumLODs > 0 ? NumLODs : Terrain->MaxLOD + 1, 1, FMath::FloorLog2(ChunkSize) + 1);
+
+	// Every tile switches level on its own, so all levels need skirts whether or not the terrain uses runtime LODs
+	FTerrainBuildData Data;
+	Data.Params = Terrain->GetBuildParams();
+	Data.Params.SkirtDepth = NumLODs > 1 ? Terrain->SkirtDepth : 0.f;
+	Data.Params.bQuantizeHeights = false;
+	TerrainBuild::Run(Data, *Terrain->GetNoiseTable());
+
+	// Levels of detail and mesh descriptions are pure CPU work per chunk
+	TArray<TArray<FMeshDescription>> Descriptions;
+	Descriptions.SetNum(Data.Chunks.Num());
+	ParallelFor(Data.Chunks.Num(), [&Data, &Descriptions, NumLODs](int32 ChunkIndex)
+	{
+		FTerrainChunk& Chunk = Data.Chunks[ChunkIndex];
+		for (int32 LOD = 0; LOD < NumLODs; LOD++)
+		{
+			TerrainBuild::BuildChunkLOD(Data, Chunk, LOD);
+			Descriptions[ChunkIndex].Add(TerrainBake::MakeTileDescription(Chunk.LODs[LOD]));
+			Chunk.LODs[LOD] = FTerrainChunkMesh();
+		}
+	});
+
+	// Match the runtime switch distances: level N starts LODDistance * 2^(N - 1) from the chunk's
+	// nearest edge. Screen size is bounds radius over distance to the centre at a 90 degree FOV.
+	const float TileRadius = 0.5f * ChunkSize * Data.Params.Scale * UE_SQRT_2;
+	auto GetScreenSize = [Terrain, TileRadius](int32 LOD)
+	{
+		return LOD == 0 ? 1.f : TileRadius / (Terrain->LODDistance * float(1 << (LOD - 1)) + TileRadius);
+	};
+
+	TArray<UStaticMesh*> Tiles;
+	for (int32 ChunkIndex = 0; ChunkIndex < Data.Chunks.Num(); ChunkIndex++)
+	{
+		const int32 TileX = ChunkIndex / Data.NumChunksY;
+		const int32 TileY = ChunkIndex % Data.NumChunksY;
+		const FString PackageName = OutputPath / Terrain->GetName() / FString::Printf(TEXT("SM_%s_%d_%d"), *Terrain->GetName(), TileX, TileY);
+
+		UPackage* Package = CreatePackage(*PackageName);
+		UStaticMesh* Tile = NewObject<UStaticMesh>(Package, *FPackageName::GetShortName(PackageName), RF_Public | RF_Standalone);
+		Tile->GetStaticMaterials().Add(FStaticMaterial(Terrain->Mat, TerrainBake::MaterialSlotName, TerrainBake::MaterialSlotName));
+		Tile->SetNumSourceModels(NumLODs);
+		Tile->bAutoComputeLODScreenSize = Terrain->LODDistance <= 0.f;
+
+		for (int32 LOD = 0; LOD < NumLODs; LOD++)
+		{
+			// The section buffers already hold final normals and tangents
+			FStaticMeshSourceModel& SourceModel = Tile->GetSourceModel(LOD);
+			SourceModel.BuildSettings.bRecomputeNormals = false;
+			SourceModel.BuildSettings.bRecomputeTangents = false;
+			SourceModel.BuildSettings.bGenerateLightmapUVs = false;
+			SourceModel.ScreenSize.Default = GetScreenSize(LOD);
+
+			Tile->CreateMeshDescription(LOD, MoveTemp(Descriptions[ChunkIndex][LOD]));
+			Tile->CommitMeshDescription(LOD);
+		}
+
+		// Collision uses the full-resolution render triangles, like the section collision it replaces
+		Tile->CreateBodySetup();
+		Tile->GetBodySetup()->CollisionTraceFlag = CTF_UseComplexAsSimple;
+
+		Tiles.Add(Tile);
+	}
+
+	// Builds render data and collision for every tile in parallel
+	UStaticMesh::BatchBuild(Tiles);
+	FStaticMeshCompilingManager::Get().FinishAllCompilation();
+
+	bool bSaved = true;
+	TArray<TSoftObjectPtr<UStaticMesh>> BakedTiles;
+	for (UStaticMesh* Tile : Tiles)
+	{
+		if (!TerrainBake::SaveAssetPackage(Tile->GetPackage(), Tile, FPackageName::GetAssetPackageExtension()))
+		{
+			UE_LOG(LogTemp, Error, TEXT("TerrainBake: failed to save %s"), *Tile->GetPathName());
+			bSaved = false;
+		}
+		BakedTiles.Add(Tile);
+	}
+
+	if (bSaved)
+	{
+		Terrain->Modify();
+		Terrain->BakedTiles = MoveTemp(BakedTiles);
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("TerrainBake: %s -> %d tiles x %d LODs under %s in %.2f s"),
+		*Terrain->GetName(), Tiles.Num(), NumLODs, *(OutputPath / Terrain->GetName()), FPlatformTime::Seconds() - StartTime);
+	return bSaved;
+}
+#endif
@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "TerrainBakeCommandlet.generated.h"
+
+class APerlinProcTerrain;
+
+/**
+ * UTerrainBakeCommandlet
+ *
+ * Bakes every APerlinProcTerrain in a map into static mesh tiles, one per chunk. Each tile carries
+ * the terrain's levels of detail, switching at the same distances the runtime LOD selection uses,
+ * and complex-as-simple collision. Tile geometry is generated on all cores and the meshes are
+ * batch-built in parallel. The saved tiles are assigned to the terrain's BakedTiles and the map
+ * is saved, so terrains with bUseBakedTiles set load them instead of generating. Streaming
+ * terrains are skipped. Editor builds only.
+ *
+ *   UnrealEditor-Cmd GAM415_Green.uproject -run=TerrainBake -Map=/Game/Maps/MyMap
+ *     [-Output=/Game/BakedTerrain] [-LODs=<count>] [-Enable]
+ */
+UCLASS()
+class UTerrainBakeCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UTerrainBakeCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+#if WITH_EDITOR
+private:
+	// Writes the tiles of one terrain under OutputPath and assigns them to it. NumLODs < 1 uses
+	// the terrain's MaxLOD. Returns false if any tile failed to save.
+	static bool BakeTerrain(APerlinProcTerrain* Terrain, const FString& OutputPath, int32 NumLODs);
+#endif
+};
@@ -0,0 +1,274 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TerrainBenchmarkCommandlet.h"
+#include "PerlinProcTerrain.h"
+#include "Algo/Find.h"                           // Looks up a case's noise mode
+#include "Engine/Engine.h"                       // World contexts for the benchmark world
+#include "Engine/World.h"                        // Throwaway game world the terrains are spawned in
+#include "HAL/PlatformMemory.h"                  // Physical memory statistics
+#include "HAL/MemoryBase.h"                      // Allocation counters
+#include "Math/RandomStream.h"                   // Repeatable impact patterns
+#include "Misc/DateTime.h"                       // Default output file name
+#include "Misc/FileHelper.h"                     // Writing the result files
+#include "Misc/Paths.h"                          // Saved/ directory
+#include "UObject/UObjectGlobals.h"              // Garbage collection between cases
+
+UTerrainBenchmarkCommandlet::UTerrainBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+UTerrainBenchmarkCommandlet::FSample UTerrainBenchmarkCommandlet::TakeSample(const APerlinProcTerrain* Terrain)
+{
+	FSample Sample;
+	Sample.Seconds = FPlatformTime::Seconds();
+	Sample.UsedPhysical = FPlatformMemory::GetStats().UsedPhysical;
+#if !UE_BUILD_SHIPPING
+	Sample.Allocations = FMalloc::TotalMallocCalls.load(std::memory_order_relaxed) + FMalloc::TotalReallocCalls.load(std::memory_order_relaxed);
+#endif
+	Sample.UploadedVertices = Terrain ? Terrain->GetNumUploadedVertices() : 0;
+	Sample.TerrainBytes = Terrain ? Terrain->GetAllocatedGridSize() : 0;
+	return Sample;
+}
+
+// Deltas only, so earlier cases (and the process's lifetime peak) never leak into a result. Used
+// physical memory includes allocator caching and can go down; the terrain's own bytes are exact.
+void UTerrainBenchmarkCommandlet::Measure(FResult& Result, const FSample& Start, const FSample& End)
+{
+	constexpr double MB = 1024.0 * 1024.0;
+
+	Result.WallMs = (End.Seconds - Start.Seconds) * 1000.0;
+	Result.UsedPhysicalDeltaMB = (double(End.UsedPhysical) - double(Start.UsedPhysical)) / MB;
+	Result.TerrainDeltaMB = (double(End.TerrainBytes) - double(Start.TerrainBytes)) / MB;
+	Result.Allocations = int64(End.Allocations - Start.Allocations);
+	Result.UploadedVertices = End.UploadedVertices - Start.UploadedVertices;
+}
+
+// Patterns cover the cases that behave differently: isolated craters, craters stacking on one
+// spot, and a line of craters sweeping across chunk borders
+void UTerrainBenchmarkCommandlet::GetImpactPattern(const FString& Pattern, int32 Size, float Scale, int32 NumImpacts, TArray<FVector>& OutPoints)
+{
+	OutPoints.Reset();
+
+	const double Extent = double(Size) * Scale;
+	FRandomStream Random(415);
+
+	for (int32 i = 0; i < NumImpacts; i++)
+	{
+		if (Pattern == TEXT("Scattered"))
+		{
+			OutPoints.Add(FVector(Random.FRandRange(0.0, Extent), Random.FRandRange(0.0, Extent), 0.0));
+		}
+		else if (Pattern == TEXT("Clustered"))
+		{
+			OutPoints.Add(FVector(Extent * 0.5 + Random.FRandRange(-2.0, 2.0) * Scale, Extent * 0.5 + Random.FRandRange(-2.0, 2.0) * Scale, 0.0));
+		}
+		else
+		{
+			const double Alpha = NumImpacts > 1 ? double(i) / (NumImpacts - 1) : 0.5;
+			OutPoints.Add(FVector(Extent * Alpha, Extent * 0.5, 0.0));
+		}
+	}
+}
+
+namespace TerrainBenchmark
+{
+	// "Classic" is the single-octave NoiseScale path; the rest are the fractal basis types
+	struct FNoiseMode
+	{
+		const TCHAR* Name;
+		bool bFractal;
+		ETerrainNoiseType Type;
+	};
+
+	static const FNoiseMode NoiseModes[] =
+	{
+		{ TEXT("Classic"), false, ETerrainNoiseType::Perlin },
+		{ TEXT("Perlin"), true, ETerrainNoiseType::Perlin },
+		{ TEXT("Simplex"), true, ETerrainNoiseType::Simplex },
+		{ TEXT("Value"), true, ETerrainNoiseType::Value },
+	};
+
+	static const TCHAR* Patterns[] = { TEXT("Scattered"), TEXT("Clustered"), TEXT("Line") };
+}
+
+void UTerrainBenchmarkCommandlet::GetCases(TConstArrayView<int32> Sizes, TConstArrayView<int32> OctaveCounts, TArray<FCase>& OutCases)
+{
+	OutCases.Reset();
+	for (const int32 Size : Sizes)
+	{
+		for (const TerrainBenchmark::FNoiseMode& Mode : TerrainBenchmark::NoiseModes)
+		{
+			// Octaves only apply to the fractal modes
+			const TConstArrayView<int32> CaseOctaves = Mode.bFractal ? OctaveCounts : TConstArrayView<int32>();
+			if (CaseOctaves.Num() == 0)
+			{
+				OutCases.Add({ Size, Mode.Name, 1 });
+			}
+			for (const int32 Octaves : CaseOctaves)
+			{
+				OutCases.Add({ Size, Mode.Name, Octaves });
+			}
+		}
+	}
+}
+
+void UTerrainBenchmarkCommandlet::RunCase(UWorld* World, const FCase& Case, const FOptions& Options, TArray<FResult>& OutResults)
+{
+	const TerrainBenchmark::FNoiseMode* Mode = Algo::FindBy(TerrainBenchmark::NoiseModes, Case.NoiseMode, [](const TerrainBenchmark::FNoiseMode& Candidate) { return FString(Candidate.Name); });
+	if (!Mode)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("TerrainBenchmark: unknown noise mode %s"), *Case.NoiseMode);
+		return;
+	}
+
+	APerlinProcTerrain* Terrain = World->SpawnActor<APerlinProcTerrain>();
+	Terrain->XSize = Case.Size;
+	Terrain->YSize = Case.Size;
+	Terrain->Scale = 100.f;
+	Terrain->UVScale = 1.f / 16.f;
+	Terrain->ZMultiplier = 1000.f;
+	Terrain->NoiseScale = 0.1f;
+	Terrain->bAsyncBuild = false;
+	Terrain->bUseHeightCache = false;
+	Terrain->bHeightFieldCollision = Options.bHeightField;
+	Terrain->bQuantizeHeights = Options.bQuantize;
+	Terrain->radius = 400.f;
+	Terrain->Depth = FVector(0.0, 0.0, 50.0);
+	Terrain->bUseFractalNoise = Mode->bFractal;
+	Terrain->NoiseType = Mode->Type;
+	Terrain->Octaves = Case.Octaves;
+
+	FResult Build;
+	Build.Size = Case.Size;
+	Build.NoiseMode = Case.NoiseMode;
+	Build.Octaves = Case.Octaves;
+	Build.Phase = TEXT("Build");
+
+	const FSample BuildStart = TakeSample(Terrain);
+	Terrain->Regenerate();
+	Measure(Build, BuildStart, TakeSample(Terrain));
+	OutResults.Add(Build);
+
+	TArray<FVector> Impacts;
+	for (const TCHAR* Pattern : TerrainBenchmark::Patterns)
+	{
+		GetImpactPattern(Pattern, Case.Size, Terrain->Scale, Options.NumImpacts, Impacts);
+
+		FResult Impact = Build;
+		Impact.Phase = FString::Printf(TEXT("Impacts:%s"), Pattern);
+
+		const FSample ImpactStart = TakeSample(Terrain);
+		for (const FVector& Point : Impacts)
+		{
+			// Aim at the surface so every impact digs a full crater
+			float SurfaceZ = 0.f;
+			Terrain->GetHeightBilinear(FVector2D(Point), SurfaceZ);
+			Terrain->AlterMesh(Terrain->GetActorLocation() + FVector(Point.X, Point.Y, SurfaceZ));
+		}
+		Measure(Impact, ImpactStart, TakeSample(Terrain));
+		OutResults.Add(Impact);
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("TerrainBenchmark: %d^2 %s x%d built in %.2f ms"), Case.Size, *Case.NoiseMode, Case.Octaves, Build.WallMs);
+
+	Terrain->Destroy();
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+}
+
+UWorld* UTerrainBenchmarkCommandlet::CreateBenchmarkWorld()
+{
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("TerrainBenchmark"));
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+	return World;
+}
+
+void UTerrainBenchmarkCommandlet::DestroyBenchmarkWorld(UWorld* World)
+{
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+}
+
+int32 UTerrainBenchmarkCommandlet::Main(const FString& Params)
+{
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	TMap<FString, FString> ParamsMap;
+	ParseCommandLine(*Params, Tokens, Switches, ParamsMap);
+
+	// Comma-separated integer lists, falling back to the defaults
+	auto ParseList = [&ParamsMap](const TCHAR* Key, TArray<int32> Default)
+	{
+		const FString* Value = ParamsMap.Find(Key);
+		if (!Value)
+		{
+			return Default;
+		}
+
+		TArray<FString> Parts;
+		Value->ParseIntoArray(Parts, TEXT(","));
+		TArray<int32> Parsed;
+		for (const FString& Part : Parts)
+		{
+			Parsed.Add(FCString::Atoi(*Part));
+		}
+		return Parsed;
+	};
+
+	TArray<FCase> Cases;
+	GetCases(ParseList(TEXT("Sizes"), GetDefaultSizes()), ParseList(TEXT("Octaves"), GetDefaultOctaves()), Cases);
+
+	FOptions Options;
+	Options.NumImpacts = ParamsMap.Contains(TEXT("Impacts")) ? FCString::Atoi(*ParamsMap[TEXT("Impacts")]) : 64;
+	Options.bHeightField = Switches.Contains(TEXT("HeightField"));
+	Options.bQuantize = Switches.Contains(TEXT("Quantize"));
+
+	const FString OutputStem = ParamsMap.Contains(TEXT("Output")) ? ParamsMap[TEXT("Output")]
+		: FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Benchmarks"), FString::Printf(TEXT("TerrainBenchmark-%s"), *FDateTime::Now().ToString()));
+
+	UWorld* World = CreateBenchmarkWorld();
+
+	TArray<FResult> Results;
+	for (const FCase& Case : Cases)
+	{
+		RunCase(World, Case, Options, Results);
+	}
+
+	DestroyBenchmarkWorld(World);
+
+	WriteCSV(OutputStem + TEXT(".csv"), Results);
+	WriteJSON(OutputStem + TEXT(".json"), Results);
+
+	UE_LOG(LogTemp, Display, TEXT("TerrainBenchmark: wrote %d results to %s.csv/.json"), Results.Num(), *OutputStem);
+	return 0;
+}
+
+void UTerrainBenchmarkCommandlet::WriteCSV(const FString& Filename, TConstArrayView<FResult> Results)
+{
+	FString Text = TEXT("Size,NoiseMode,Octaves,Phase,WallMs,UsedPhysicalDeltaMB,TerrainDeltaMB,Allocations,UploadedVertices\n");
+	for (const FResult& Result : Results)
+	{
+		Text += FString::Printf(TEXT("%d,%s,%d,%s,%.3f,%.3f,%.3f,%lld,%lld\n"), Result.Size, *Result.NoiseMode, Result.Octaves, *Result.Phase,
+			Result.WallMs, Result.UsedPhysicalDeltaMB, Result.TerrainDeltaMB, Result.Allocations, Result.UploadedVertices);
+	}
+	FFileHelper::SaveStringToFile(Text, *Filename);
+}
+
+void UTerrainBenchmarkCommandlet::WriteJSON(const FString& Filename, TConstArrayView<FResult> Results)
+{
+	FString Text = TEXT("[\n");
+	for (int32 i = 0; i < Results.Num(); i++)
+	{
+		const FResult& Result = Results[i];
+		Text += FString::Printf(TEXT("  {\"Size\": %d, \"NoiseMode\": \"%s\", \"Octaves\": %d, \"Phase\": \"%s\", \"WallMs\": %.3f, ")
+			TEXT("\"UsedPhysicalDeltaMB\": %.3f, \"TerrainDeltaMB\": %.3f, \"Allocations\": %lld, \"UploadedVertices\": %lld}%s\n"),
+			Result.Size, *Result.NoiseMode, Result.Octaves, *Result.Phase, Result.WallMs, Result.UsedPhysicalDeltaMB,
+			Result.TerrainDeltaMB, Result.Allocations, Result.UploadedVertices, i + 1 < Results.Num() ? TEXT(",") : TEXT(""));
+	}
+	Text += TEXT("]\n");
+	FFileHelper::SaveStringToFile(Text, *Filename);
+}
@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "TerrainBenchmarkCommandlet.generated.h"
+
+class APerlinProcTerrain;
+class UWorld;
+
+/**
+ * UTerrainBenchmarkCommandlet
+ *
+ * Headless performance suite for APerlinProcTerrain. For every grid size, noise mode and octave
+ * count it builds a terrain in a throwaway game world, then fires scripted impact patterns through
+ * AlterMesh. Wall time, memory, allocation count and uploaded vertices of every phase are written
+ * as CSV and JSON so runs from different builds can be compared. The same cases also run as the
+ * GAM415_Green.Terrain.Benchmark performance automation tests.
+ *
+ *   UnrealEditor-Cmd GAM415_Green.uproject -run=TerrainBenchmark -nullrhi -unattended
+ *     [-Sizes=64,256,1024,2048] [-Octaves=1,4,8] [-Impacts=64] [-Output=<path without extension>]
+ *     [-HeightField] [-Quantize]
+ */
+UCLASS()
+class UTerrainBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UTerrainBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+	// One measured phase of one case. Memory is what the phase itself added: the change in the
+	// process's used physical memory, and the change in what the terrain holds for its grid.
+	struct FResult
+	{
+		int32 Size = 0;
+		FString NoiseMode;
+		int32 Octaves = 0;
+		FString Phase;
+		double WallMs = 0.0;
+		double UsedPhysicalDeltaMB = 0.0;
+		double TerrainDeltaMB = 0.0;
+		int64 Allocations = 0;
+		int64 UploadedVertices = 0;
+	};
+
+	// One grid size, noise mode and octave count
+	struct FCase
+	{
+		int32 Size = 0;
+		FString NoiseMode;
+		int32 Octaves = 1;
+	};
+
+	// Settings shared by every case of a run
+	struct FOptions
+	{
+		int32 NumImpacts = 64;
+		bool bHeightField = false;
+		bool bQuantize = false;
+	};
+
+	// Sizes and octave counts run when none are given
+	static TArray<int32> GetDefaultSizes() { return { 64, 256, 1024, 2048 }; }
+	static TArray<int32> GetDefaultOctaves() { return { 1, 4, 8 }; }
+
+	// Every noise mode for each size, and every octave count for the fractal modes
+	static void GetCases(TConstArrayView<int32> Sizes, TConstArrayView<int32> OctaveCounts, TArray<FCase>& OutCases);
+
+	// Builds the case's terrain in World, fires each impact pattern at it, and appends one result per phase
+	static void RunCase(UWorld* World, const FCase& Case, const FOptions& Options, TArray<FResult>& OutResults);
+
+	// Throwaway game world for RunCase, and its teardown
+	static UWorld* CreateBenchmarkWorld();
+	static void DestroyBenchmarkWorld(UWorld* World);
+
+private:
+	// Counters sampled before and after each phase
+	struct FSample
+	{
+		double Seconds = 0.0;
+		uint64 UsedPhysical = 0;
+		uint64 Allocations = 0;
+		int64 UploadedVertices = 0;
+		SIZE_T TerrainBytes = 0;
+	};
+
+	static FSample TakeSample(const APerlinProcTerrain* Terrain);
+
+	// Fills in the measurements of a phase from the difference between its start and end samples
+	static void Measure(FResult& Result, const FSample& Start, const FSample& End);
+
+	// Local-space impact points of a named pattern on a Size x Size grid
+	static void GetImpactPattern(const FString& Pattern, int32 Size, float Scale, int32 NumImpacts, TArray<FVector>& OutPoints);
+
+	static void WriteCSV(const FString& Filename, TConstArrayView<FResult> Results);
+	static void WriteJSON(const FString& Filename, TConstArrayView<FResult> Results);
+};
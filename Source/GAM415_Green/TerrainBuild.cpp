@@ -0,0 +1,612 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TerrainBuild.h"
+#include "TerrainHeightCache.h"
+#include "TerrainOctaveCache.h"
+#include "Algo/BinarySearch.h"                   // Finds the LOD samples inside a dirty rectangle
+#include "Async/ParallelFor.h"                   // Splits grid generation across worker threads
+#include "Misc/ScopeLock.h"                      // Guards the shared triangle cache
+#include "ProfilingDebugging/CpuProfilerTrace.h" // Named CPU scopes for Unreal Insights
+
+namespace TerrainBuild
+{
+	// Generates heights for a grid-based terrain using Perlin noise for height variation
+	void GenerateHeights(const FTerrainBuildParams& Params, const FTerrainNoiseTable& Table, TArray<float>& OutHeights)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(TerrainBuild::GenerateHeights);
+
+		const int32 RowLength = Params.YSize + 1;
+
+		// Size the buffer once; every row writes straight into its final slots
+		OutHeights.SetNumUninitialized((Params.XSize + 1) * RowLength, EAllowShrinking::No);
+
+		// Coarse grids skip octaves too fine to show at their spacing. The kept octaves stay at their
+		// full-sum weight and the skipped ones add their mean, so silhouettes match the full sum.
+		FTerrainNoiseSettings Noise = Params.Noise;
+		float OctaveScale = 1.f, OctaveBias = 0.f;
+		if (Params.bUseFractalNoise && Params.OctaveCullCycles > 0.f)
+		{
+			const int32 NumOctaves = TerrainNoise::GetResolvedOctaves(Params.Noise, Params.Scale, Params.OctaveCullCycles);
+			if (NumOctaves < Noise.Octaves)
+			{
+				TerrainNoise::GetCulledOctaveCorrection(Table, Params.Noise, NumOctaves, OctaveScale, OctaveBias);
+				Noise.Octaves = NumOctaves;
+			}
+		}
+
+		// The noise mode is fixed for the whole build, so resolve its kernel once
+		const TerrainNoise::FRowKernel RowKernel = Params.bUseFractalNoise ? TerrainNoise::GetRowKernel(Noise) : nullptr;
+
+		// Rows are independent, so generate them in parallel
+		ParallelFor(Params.XSize + 1, [&Params, &Table, &OutHeights, &Noise, RowLength, RowKernel, OctaveScale, OctaveBias](int32 X)
+		{
+			// Noise follows the global grid coordinate so streamed chunks line up
+			const int32 GridX = Params.Origin.X + X;
+			float* RowHeights = &OutHeights[X * RowLength];
+
+			if (RowKernel)
+			{
+				// Fractal heights come from the batch kernel a whole row at a time. Without culling the
+				// correction is exactly 1 and 0, so full evaluations are unchanged.
+				RowKernel(Table, Noise, FVector2f(GridX * Params.Scale, Params.Origin.Y * Params.Scale), FVector2f(0.f, Params.Scale), RowLength, RowHeights);
+				for (int Y = 0; Y <= Params.YSize; Y++)
+				{
+					RowHeights[Y] = (RowHeights[Y] * OctaveScale + OctaveBias) * Params.ZMultiplier;
+				}
+				return;
+			}
+
+			for (int Y = 0; Y <= Params.YSize; Y++)
+			{
+				// Generate a Perlin noise value based on scaled X and Y positions
+				const int32 GridY = Params.Origin.Y + Y;
+				RowHeights[Y] = FMath::PerlinNoise2D(FVector2D(GridX * Params.NoiseScale + 0.1, GridY * Params.NoiseScale + 0.1)) * Params.ZMultiplier;
+			}
+		});
+	}
+
+	// Splits the vertex grid into ChunkSize x ChunkSize quad tiles, one mesh section each
+	void CreateChunks(FTerrainBuildData& Data)
+	{
+		const FTerrainBuildParams& Params = Data.Params;
+
+		Data.Chunks.Reset();
+		if (Params.XSize <= 0 || Params.YSize <= 0)
+		{
+			Data.NumChunksX = Data.NumChunksY = 0;
+			return;
+		}
+
+		const int32 QuadsPerChunk = FMath::Max(1, Params.ChunkSize);
+		Data.NumChunksX = FMath::DivideAndRoundUp(Params.XSize, QuadsPerChunk);
+		Data.NumChunksY = FMath::DivideAndRoundUp(Params.YSize, QuadsPerChunk);
+
+		Data.Chunks.SetNum(Data.NumChunksX * Data.NumChunksY);
+
+		for (int32 ChunkX = 0; ChunkX < Data.NumChunksX; ChunkX++)
+		{
+			for (int32 ChunkY = 0; ChunkY < Data.NumChunksY; ChunkY++)
+			{
+				FTerrainChunk& Chunk = Data.Chunks[ChunkX * Data.NumChunksY + ChunkY];
+				Chunk.SectionIndex = ChunkX * Data.NumChunksY + ChunkY;
+
+				// Chunks on the far edges are clipped to the grid and may be smaller
+				Chunk.Min = FIntPoint(ChunkX * QuadsPerChunk, ChunkY * QuadsPerChunk);
+				Chunk.Max = FIntPoint(FMath::Min(Chunk.Min.X + QuadsPerChunk, Params.XSize), FMath::Min(Chunk.Min.Y + QuadsPerChunk, Params.YSize));
+			}
+		}
+	}
+
+	// Grid coordinates sampled along one chunk axis at a level of detail; the last is always Max
+	static void GetLODSamples(int32 Min, int32 Max, int32 LOD, TArray<int32, TInlineAllocator<130>>& OutSamples)
+	{
+		const int32 Step = 1 << LOD;
+
+		OutSamples.Reset();
+		for (int32 Coord = Min; Coord < Max; Coord += Step)
+		{
+			OutSamples.Add(Coord);
+		}
+		OutSamples.Add(Max);
+	}
+
+	// Local index of the k-th vertex walking the border of an NumX x NumY vertex grid
+	// (+X along the first row, +Y up the last column, back along the last row, down the first column)
+	static int32 GetBorderVertex(int32 NumX, int32 NumY, int32 k)
+	{
+		if (k < NumX)                  { return k * NumY; }
+		k -= NumX - 1;
+		if (k < NumY)                  { return (NumX - 1) * NumY + k; }
+		k -= NumY - 1;
+		if (k < NumX)                  { return (NumX - 1 - k) * NumY + NumY - 1; }
+		k -= NumX - 1;
+		return NumY - 1 - k;
+	}
+
+	// Quads per strip in CreateTriangles. A strip row shares StripWidth + 1 vertices with the row
+	// before it, so two rows (18 vertices) fit comfortably in a post-transform cache.
+	static constexpr int32 StripWidth = 8;
+
+	// Creates triangle indices for connecting the chunk's sampled vertex grid into a mesh surface,
+	// followed by the skirt quads along its border
+	static void CreateTriangles(int32 NumX, int32 NumY, bool bSkirt, TArray<int32>& OutTriangles)
+	{
+		const int32 RowLength = NumY;
+		const int32 QuadsX = NumX - 1;
+		const int32 QuadsY = NumY - 1;
+		const int32 NumBorder = 2 * (QuadsX + QuadsY);
+
+		// Six indices per quad, written straight into their final slots
+		OutTriangles.SetNumUninitialized((QuadsX * QuadsY + (bSkirt ? NumBorder : 0)) * 6);
+		int32* Out = OutTriangles.GetData();
+
+		// Walk the grid in strips StripWidth quads wide rather than full rows, so each quad's
+		// vertices are still cached from the row before it instead of a whole chunk width ago
+		for (int32 StripStart = 0; StripStart < QuadsY; StripStart += StripWidth)
+		{
+			const int32 StripEnd = FMath::Min(StripStart + StripWidth, QuadsY);
+			for (int32 X = 0; X < QuadsX; X++)
+			{
+				for (int32 Y = StripStart; Y < StripEnd; Y++)
+				{
+					const int32 Vertex = X * RowLength + Y;
+
+					// Define two triangles for each quad in the grid
+					*Out++ = Vertex;
+					*Out++ = Vertex + 1;
+					*Out++ = Vertex + RowLength;
+
+					*Out++ = Vertex + 1;
+					*Out++ = Vertex + RowLength + 1;
+					*Out++ = Vertex + RowLength;
+				}
+			}
+		}
+
+		if (!bSkirt)
+		{
+			return;
+		}
+
+		// One vertical quad per border edge, wound to face away from the chunk. Skirt vertex k
+		// sits directly below border vertex k.
+		const int32 FirstSkirt = NumX * NumY;
+		for (int32 k = 0; k < NumBorder; k++)
+		{
+			const int32 Next = (k + 1) % NumBorder;
+			const int32 A = GetBorderVertex(NumX, NumY, k);
+			const int32 B = GetBorderVertex(NumX, NumY, Next);
+
+			*Out++ = A;
+			*Out++ = B;
+			*Out++ = FirstSkirt + k;
+
+			*Out++ = B;
+			*Out++ = FirstSkirt + Next;
+			*Out++ = FirstSkirt + k;
+		}
+	}
+
+	TSharedRef<const TArray<int32>, ESPMode::ThreadSafe> GetSharedTriangles(int32 NumX, int32 NumY, bool bSkirt)
+	{
+		// Only a handful of layouts exist (full chunks, clipped edge chunks, and their levels of
+		// detail), so the cache is never trimmed
+		static FCriticalSection CacheLock;
+		static TMap<uint64, TSharedRef<const TArray<int32>, ESPMode::ThreadSafe>> Cache;
+
+		const uint64 Key = uint64(uint32(NumX)) | (uint64(uint32(NumY)) << 31) | (uint64(bSkirt) << 62);
+
+		FScopeLock Lock(&CacheLock);
+		if (const TSharedRef<const TArray<int32>, ESPMode::ThreadSafe>* Found = Cache.Find(Key))
+		{
+			return *Found;
+		}
+
+		TSharedRef<TArray<int32>, ESPMode::ThreadSafe> Triangles = MakeShared<TArray<int32>, ESPMode::ThreadSafe>();
+		CreateTriangles(NumX, NumY, bSkirt, *Triangles);
+		Cache.Add(Key, Triangles);
+		return Triangles;
+	}
+
+	// Precomputed splat thresholds, so the per-vertex work is a few multiplies
+	struct FSplatRule
+	{
+		// Rock weight rises as the normal's Z falls from CosStart to CosEnd
+		float CosStart;
+		float InvCosRange;
+
+		// Snow weight rises as the height climbs through [SnowStart, SnowStart + SnowRange]
+		float SnowStart;
+		float InvSnowRange;
+
+		explicit FSplatRule(const FTerrainBuildParams& Params)
+		{
+			CosStart = FMath::Cos(FMath::DegreesToRadians(Params.RockSlopeStart));
+			InvCosRange = 1.f / FMath::Max(CosStart - FMath::Cos(FMath::DegreesToRadians(Params.RockSlopeEnd)), UE_KINDA_SMALL_NUMBER);
+			SnowStart = Params.SnowHeight - Params.SnowBlend;
+			InvSnowRange = 1.f / FMath::Max(2.f * Params.SnowBlend, UE_KINDA_SMALL_NUMBER);
+		}
+
+		// Grass, rock and snow weights in R, G and B, summing to 255; rock wins over snow on steep ground
+		FColor GetColor(float Z, const FVector& Normal) const
+		{
+			const float Rock = FMath::SmoothStep(0.f, 1.f, (CosStart - float(Normal.Z)) * InvCosRange);
+			const float Snow = FMath::SmoothStep(0.f, 1.f, (Z - SnowStart) * InvSnowRange) * (1.f - Rock);
+
+			const uint8 RockByte = uint8(FMath::RoundToInt(Rock * 255.f));
+			const uint8 SnowByte = uint8(FMath::Min(FMath::RoundToInt(Snow * 255.f), 255 - RockByte));
+			return FColor(uint8(255 - RockByte - SnowByte), RockByte, SnowByte, 255);
+		}
+	};
+
+	// Writes every attribute of the sampled vertices inside Local (an inclusive rectangle of sample
+	// indices), then the skirt vertices that copy any of them. Mesh must already be sized for the samples.
+	static void WriteChunkVertices(const FTerrainBuildData& Data, TConstArrayView<int32> SamplesX, TConstArrayView<int32> SamplesY, const FIntRect& Local, FTerrainChunkMesh& Mesh)
+	{
+		const int32 NumX = SamplesX.Num();
+		const int32 NumY = SamplesY.Num();
+		const bool bSkirt = Data.Params.SkirtDepth > 0.f;
+		const int32 NumBorder = 2 * (NumX - 1 + NumY - 1);
+		const bool bSplat = Data.Params.bSplatColors;
+		const FSplatRule Splat(Data.Params);
+
+		FVector* Vertices = Mesh.Vertices.GetData();
+		FVector2D* UV0 = Mesh.UV0.GetData();
+		FVector* Normals = Mesh.Normals.GetData();
+		FProcMeshTangent* Tangents = Mesh.Tangents.GetData();
+		FColor* Colors = Mesh.Colors.GetData();
+
+		// One walk over the sampled grid writes every attribute of a vertex while its heights and
+		// those of its neighbours are still in cache. Everything but the height follows from the grid
+		// coordinate; normals always use the full-resolution heights around the sample, so coarse
+		// levels keep the fine shading.
+		for (int32 LocalX = Local.Min.X; LocalX <= Local.Max.X; LocalX++)
+		{
+			const int32 X = SamplesX[LocalX];
+			for (int32 LocalY = Local.Min.Y; LocalY <= Local.Max.Y; LocalY++)
+			{
+				const int32 Y = SamplesY[LocalY];
+				const int32 Target = LocalX * NumY + LocalY;
+
+				Vertices[Target] = Data.GetVertex(X, Y);
+				UV0[Target] = Data.GetUV(X, Y);
+				Data.GetNormalAndTangent(X, Y, Normals[Target], Tangents[Target]);
+
+				if (bSplat)
+				{
+					Colors[Target] = Splat.GetColor(float(Vertices[Target].Z), Normals[Target]);
+				}
+			}
+		}
+
+		if (!bSkirt)
+		{
+			return;
+		}
+
+		// Skirt vertices copy their border vertex, dropped by SkirtDepth, so shading matches the edge
+		const FVector Drop(0.0, 0.0, Data.Params.SkirtDepth);
+		for (int32 k = 0; k < NumBorder; k++)
+		{
+			const int32 Border = GetBorderVertex(NumX, NumY, k);
+			const int32 BorderX = Border / NumY;
+			const int32 BorderY = Border % NumY;
+			if (BorderX < Local.Min.X || BorderX > Local.Max.X || BorderY < Local.Min.Y || BorderY > Local.Max.Y)
+			{
+				continue;
+			}
+
+			const int32 Target = NumX * NumY + k;
+			Vertices[Target] = Vertices[Border] - Drop;
+			UV0[Target] = UV0[Border];
+			Normals[Target] = Normals[Border];
+			Tangents[Target] = Tangents[Border];
+			if (bSplat)
+			{
+				Colors[Target] = Colors[Border];
+			}
+		}
+	}
+
+	void FillChunkVertices(const FTerrainBuildData& Data, const FTerrainChunk& Chunk, int32 LOD, FTerrainChunkMesh& Mesh)
+	{
+		TArray<int32, TInlineAllocator<130>> SamplesX;
+		TArray<int32, TInlineAllocator<130>> SamplesY;
+		GetLODSamples(Chunk.Min.X, Chunk.Max.X, LOD, SamplesX);
+		GetLODSamples(Chunk.Min.Y, Chunk.Max.Y, LOD, SamplesY);
+
+		const int32 NumX = SamplesX.Num();
+		const int32 NumY = SamplesY.Num();
+		const bool bSkirt = Data.Params.SkirtDepth > 0.f;
+		const int32 NumBorder = 2 * (NumX - 1 + NumY - 1);
+		const int32 NumVertices = NumX * NumY + (bSkirt ? NumBorder : 0);
+
+		Mesh.Vertices.SetNumUninitialized(NumVertices, EAllowShrinking::No);
+		Mesh.UV0.SetNumUninitialized(NumVertices, EAllowShrinking::No);
+		Mesh.Normals.SetNumUninitialized(NumVertices, EAllowShrinking::No);
+		Mesh.Tangents.SetNumUninitialized(NumVertices, EAllowShrinking::No);
+
+		if (Data.Params.bSplatColors)
+		{
+			Mesh.Colors.SetNumUninitialized(NumVertices, EAllowShrinking::No);
+		}
+		else
+		{
+			Mesh.Colors.Reset();
+		}
+
+		WriteChunkVertices(Data, SamplesX, SamplesY, FIntRect(0, 0, NumX - 1, NumY - 1), Mesh);
+	}
+
+	bool FillChunkVertices(const FTerrainBuildData& Data, const FTerrainChunk& Chunk, int32 LOD, FTerrainChunkMesh& Mesh, const FIntRect& Rect)
+	{
+		TArray<int32, TInlineAllocator<130>> SamplesX;
+		TArray<int32, TInlineAllocator<130>> SamplesY;
+		GetLODSamples(Chunk.Min.X, Chunk.Max.X, LOD, SamplesX);
+		GetLODSamples(Chunk.Min.Y, Chunk.Max.Y, LOD, SamplesY);
+
+		const int32 NumX = SamplesX.Num();
+		const int32 NumY = SamplesY.Num();
+		const int32 NumVertices = NumX * NumY + (Data.Params.SkirtDepth > 0.f ? 2 * (NumX - 1 + NumY - 1) : 0);
+		if (Mesh.Vertices.Num() != NumVertices || (Data.Params.bSplatColors && Mesh.Colors.Num() != NumVertices))
+		{
+			FillChunkVertices(Data, Chunk, LOD, Mesh);
+			return true;
+		}
+
+		// Samples are sorted, so the ones inside the rectangle form one contiguous run per axis
+		const FIntRect Local(
+			Algo::LowerBound(SamplesX, Rect.Min.X), Algo::LowerBound(SamplesY, Rect.Min.Y),
+			Algo::UpperBound(SamplesX, Rect.Max.X) - 1, Algo::UpperBound(SamplesY, Rect.Max.Y) - 1);
+		if (Local.Max.X < Local.Min.X || Local.Max.Y < Local.Min.Y)
+		{
+			return false;
+		}
+
+		WriteChunkVertices(Data, SamplesX, SamplesY, Local, Mesh);
+		return true;
+	}
+
+	void BuildChunkLOD(const FTerrainBuildData& Data, FTerrainChunk& Chunk, int32 LOD)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(TerrainBuild::BuildChunkLOD);
+
+		if (Chunk.LODs.Num() <= LOD)
+		{
+			Chunk.LODs.SetNum(LOD + 1);
+		}
+
+		FTerrainChunkMesh& Mesh = Chunk.LODs[LOD];
+		const int32 Step = 1 << LOD;
+		const int32 NumX = FMath::DivideAndRoundUp(Chunk.NumX() - 1, Step) + 1;
+		const int32 NumY = FMath::DivideAndRoundUp(Chunk.NumY() - 1, Step) + 1;
+
+		Mesh.Triangles = GetSharedTriangles(NumX, NumY, Data.Params.SkirtDepth > 0.f);
+		FillChunkVertices(Data, Chunk, LOD, Mesh);
+	}
+
+	void BuildStreamedChunk(FTerrainBuildData& Data, const FTerrainNoiseTable& Table, const FIntPoint& ChunkCoord, int32 SectionIndex, int32 LOD, float OctaveCullCycles)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(TerrainBuild::BuildStreamedChunk);
+
+		// A coarse chunk is an ordinary chunk on a grid 1 << LOD times wider, so its vertices land on
+		// the full-resolution grid and the noise is sampled at the same world positions
+		const int32 Step = 1 << LOD;
+		const int32 QuadsPerChunk = FMath::Max(1, Data.Params.ChunkSize / Step);
+		Data.Params.Scale *= Step;
+		Data.Params.UVScale *= Step;
+		Data.Params.NoiseScale *= Step;
+
+		// Only coarse chunks are culled, so near chunks always match the full evaluation
+		Data.Params.OctaveCullCycles = LOD > 0 ? OctaveCullCycles : 0.f;
+
+		// One extra vertex on every side gives the border normals real neighbours, so lighting
+		// matches across chunk seams; the apron itself is never uploaded. Skirts (from SkirtDepth)
+		// hide the cracks against neighbours at another level.
+		Data.Params.Origin = ChunkCoord * QuadsPerChunk - FIntPoint(1, 1);
+		Data.Params.XSize = QuadsPerChunk + 2;
+		Data.Params.YSize = QuadsPerChunk + 2;
+		Data.bFromHeightCache = false;
+
+		// Recycled chunks regenerate into the float storage they already own
+		TArray<float> Heights = Data.Heights.TakeValues();
+		GenerateHeights(Data.Params, Table, Heights);
+		Data.Heights.Assign(MoveTemp(Heights), false);
+
+		// Reusing the chunk entry keeps its buffers' allocations from the previous occupant
+		Data.Chunks.SetNum(1);
+		Data.NumChunksX = Data.NumChunksY = 1;
+
+		FTerrainChunk& Chunk = Data.Chunks[0];
+		Chunk.SectionIndex = SectionIndex;
+		Chunk.Min = FIntPoint(1, 1);
+		Chunk.Max = FIntPoint(QuadsPerChunk + 1, QuadsPerChunk + 1);
+		Chunk.CurrentLOD = 0;
+		Chunk.LODs.SetNum(1);
+
+		BuildChunkLOD(Data, Chunk, 0);
+	}
+
+	// Runs the whole pipeline, checking for cancellation between stages
+	bool Run(FTerrainBuildData& Data, const FTerrainNoiseTable& Table, const std::atomic<bool>* bCancelled, FTerrainOctaveCache* OctaveCache)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(TerrainBuild::Run);
+
+		auto IsCancelled = [bCancelled]() { return bCancelled && bCancelled->load(std::memory_order_relaxed); };
+
+		const FTerrainBuildParams& Params = Data.Params;
+		TArray<float> Heights;
+
+		// A cache hit replaces noise generation entirely; the heights are read straight from the mapped file
+		if (Params.bUseHeightCache)
+		{
+			Data.bFromHeightCache = TerrainHeightCache::Read(Params, [&Heights, &Params](const float* CachedHeights)
+			{
+				Heights.SetNumUninitialized((Params.XSize + 1) * (Params.YSize + 1));
+				FMemory::Memcpy(Heights.GetData(), CachedHeights, Heights.Num() * sizeof(float));
+			});
+		}
+
+		if (!Data.bFromHeightCache)
+		{
+			if (OctaveCache && Params.bUseFractalNoise)
+			{
+				if (!OctaveCache->GenerateHeights(Params, Table, Heights, bCancelled)) { return false; }
+			}
+			else
+			{
+				GenerateHeights(Params, Table, Heights);
+			}
+			if (IsCancelled()) { return false; }
+
+			// Store the heights for the next run with the same parameters
+			if (Params.bUseHeightCache)
+			{
+				TerrainHeightCache::Write(Params, Heights);
+			}
+		}
+
+		// Chunk buffers are left to the consumer, which builds each one as it needs it; holding every
+		// chunk's vertices at once would cost more than the heights themselves
+		Data.Heights.Assign(MoveTemp(Heights), Params.bQuantizeHeights);
+		CreateChunks(Data);
+
+		return !IsCancelled();
+	}
+}
+
+// Central differences across the neighbouring heights; one-sided on the grid edges
+void FTerrainBuildData::GetNormalAndTangent(int32 X, int32 Y, FVector& OutNormal, FProcMeshTangent& OutTangent) const
+{
+	const int32 X0 = FMath::Max(X - 1, 0);
+	const int32 X1 = FMath::Min(X + 1, Params.XSize);
+	const int32 Y0 = FMath::Max(Y - 1, 0);
+	const int32 Y1 = FMath::Min(Y + 1, Params.YSize);
+
+	// Height change per world unit along each grid axis
+	const double SlopeX = (GetHeight(X1, Y) - GetHeight(X0, Y)) / FMath::Max(double(X1 - X0) * Params.Scale, UE_DOUBLE_SMALL_NUMBER);
+	const double SlopeY = (GetHeight(X, Y1) - GetHeight(X, Y0)) / FMath::Max(double(Y1 - Y0) * Params.Scale, UE_DOUBLE_SMALL_NUMBER);
+
+	// U runs along +X, so the tangent follows the surface in that direction
+	OutNormal = FVector(-SlopeX, -SlopeY, 1.0).GetSafeNormal();
+	OutTangent = FProcMeshTangent(FVector(1.0, 0.0, SlopeX).GetSafeNormal(), false);
+}
+
+// The same interpolation the grid queries have always used: clamp to the cell, then lerp along
+// Y and X. The normal is the cross product of the patch's partial derivatives at that point.
+bool FTerrainBuildData::SampleBilinear(const FVector2D& GridXY, float& OutZ, FVector* OutNormal) const
+{
+	if (Heights.Num() == 0 || Params.Scale <= 0.f || Params.XSize <= 0 || Params.YSize <= 0)
+	{
+		return false;
+	}
+
+	if (GridXY.X < 0.0 || GridXY.Y < 0.0 || GridXY.X > Params.XSize || GridXY.Y > Params.YSize)
+	{
+		return false;
+	}
+
+	// Clamp the cell so points on the far edges still use the last row/column of quads
+	const int32 X0 = FMath::Min(FMath::FloorToInt(GridXY.X), Params.XSize - 1);
+	const int32 Y0 = FMath::Min(FMath::FloorToInt(GridXY.Y), Params.YSize - 1);
+	const float FracX = float(GridXY.X - X0);
+	const float FracY = float(GridXY.Y - Y0);
+
+	const float Z00 = GetHeight(X0, Y0);
+	const float Z01 = GetHeight(X0, Y0 + 1);
+	const float Z10 = GetHeight(X0 + 1, Y0);
+	const float Z11 = GetHeight(X0 + 1, Y0 + 1);
+
+	OutZ = FMath::Lerp(FMath::Lerp(Z00, Z01, FracY), FMath::Lerp(Z10, Z11, FracY), FracX);
+
+	if (OutNormal)
+	{
+		const float SlopeX = FMath::Lerp(Z10 - Z00, Z11 - Z01, FracY) / Params.Scale;
+		const float SlopeY = FMath::Lerp(Z01 - Z00, Z11 - Z10, FracX) / Params.Scale;
+		*OutNormal = FVector(-SlopeX, -SlopeY, 1.f).GetSafeNormal();
+	}
+
+	return true;
+}
+
+void FTerrainHeights::Assign(TArray<float>&& InHeights, bool bQuantize)
+{
+	Reset();
+
+	if (!bQuantize)
+	{
+		Values = MoveTemp(InHeights);
+		return;
+	}
+
+	float Min = TNumericLimits<float>::Max();
+	float Max = TNumericLimits<float>::Lowest();
+	for (const float Z : InHeights)
+	{
+		Min = FMath::Min(Min, Z);
+		Max = FMath::Max(Max, Z);
+	}
+
+	const float Headroom = FMath::Max((Max - Min) * RangeHeadroom, 1.f);
+	Quantize(InHeights, Min - Headroom, Max + Headroom);
+}
+
+TArray<float> FTerrainHeights::TakeValues()
+{
+	TArray<float> Taken = MoveTemp(Values);
+	Reset();
+	return Taken;
+}
+
+void FTerrainHeights::Reset()
+{
+	Values.Reset();
+	Quantized.Empty();
+	RangeMin = RangeStep = 0.f;
+	bQuantized = false;
+}
+
+bool FTerrainHeights::Set(int32 Index, float Z)
+{
+	if (!bQuantized)
+	{
+		Values[Index] = Z;
+		return false;
+	}
+
+	bool bReencoded = false;
+	const float RangeMax = RangeMin + RangeStep * float(MAX_uint16);
+	if (Z < RangeMin || Z > RangeMax)
+	{
+		// Widen with fresh headroom so a run of craters does not re-encode the grid on every hit
+		TArray<float> Decoded;
+		Decoded.SetNumUninitialized(Quantized.Num());
+		for (int32 i = 0; i < Quantized.Num(); i++)
+		{
+			Decoded[i] = Get(i);
+		}
+
+		const float Headroom = FMath::Max((RangeMax - RangeMin) * RangeHeadroom, 1.f);
+		Quantize(Decoded, FMath::Min(RangeMin, Z - Headroom), FMath::Max(RangeMax, Z + Headroom));
+		bReencoded = true;
+	}
+
+	Quantized[Index] = uint16(FMath::Clamp(FMath::RoundToInt((Z - RangeMin) / FMath::Max(RangeStep, UE_SMALL_NUMBER)), 0, int32(MAX_uint16)));
+	return bReencoded;
+}
+
+void FTerrainHeights::Quantize(TConstArrayView<float> Source, float Min, float Max)
+{
+	RangeMin = Min;
+	RangeStep = (Max - Min) / float(MAX_uint16);
+	bQuantized = true;
+
+	Values.Empty();
+	Quantized.SetNumUninitialized(Source.Num());
+
+	const float InvStep = RangeStep > 0.f ? 1.f / RangeStep : 0.f;
+	for (int32 i = 0; i < Source.Num(); i++)
+	{
+		Quantized[i] = uint16(FMath::Clamp(FMath::RoundToInt((Source[i] - RangeMin) * InvStep), 0, int32(MAX_uint16)));
+	}
+}
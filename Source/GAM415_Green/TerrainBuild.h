@@ -0,0 +1,338 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProceduralMeshComponent.h"   // FProcMeshTangent
+#include "TerrainNoise.h"
+#include <atomic>
+
+class FTerrainOctaveCache;
+
+/**
+ * FTerrainChunkMesh
+ *
+ * Section buffers for one level of detail of a chunk, ready for upload.
+ */
+struct FTerrainChunkMesh
+{
+	// Section-local vertex positions; skirt vertices, if any, follow the surface grid
+	TArray<FVector> Vertices;
+
+	// Section-local normals and tangents
+	TArray<FVector> Normals;
+	TArray<FProcMeshTangent> Tangents;
+
+	// Section-local UV coordinates
+	TArray<FVector2D> UV0;
+
+	// Splat weights (R grass, G rock, B snow), empty unless FTerrainBuildParams::bSplatColors is set
+	TArray<FColor> Colors;
+
+	// Section-local triangle indices, shared by every chunk level with the same vertex layout
+	TSharedPtr<const TArray<int32>, ESPMode::ThreadSafe> Triangles;
+
+	// LODs are generated on first use; an empty mesh has not been generated yet (or was released)
+	bool IsEmpty() const { return Vertices.Num() == 0; }
+
+	// Bytes held by the buffers; the shared triangle indices are not counted
+	SIZE_T GetAllocatedSize() const
+	{
+		return Vertices.GetAllocatedSize() + Normals.GetAllocatedSize() + Tangents.GetAllocatedSize()
+			+ UV0.GetAllocatedSize() + Colors.GetAllocatedSize();
+	}
+};
+
+/**
+ * FTerrainChunk
+ *
+ * A rectangular tile of the terrain grid that is uploaded as its own mesh section.
+ * Neighbouring chunks share their border vertices so the surface stays watertight. Coarser
+ * levels of detail sample every (1 << LOD)th grid vertex and hang a skirt off the chunk's
+ * border to hide cracks against neighbours at a different level.
+ */
+struct FTerrainChunk
+{
+	// Mesh section index on the procedural mesh component
+	int32 SectionIndex = INDEX_NONE;
+
+	// First grid vertex covered by this chunk (inclusive)
+	FIntPoint Min = FIntPoint::ZeroValue;
+
+	// Last grid vertex covered by this chunk (inclusive)
+	FIntPoint Max = FIntPoint::ZeroValue;
+
+	// Section buffers per level of detail, each built when the chunk first needs it
+	TArray<FTerrainChunkMesh> LODs;
+
+	// Level of detail currently uploaded to the mesh section
+	int32 CurrentLOD = 0;
+
+	// Number of vertices along each axis of the chunk
+	int32 NumX() const { return Max.X - Min.X + 1; }
+	int32 NumY() const { return Max.Y - Min.Y + 1; }
+
+	// Buffers of the level of detail currently uploaded
+	const FTerrainChunkMesh& GetCurrentMesh() const { return LODs[CurrentLOD]; }
+};
+
+/**
+ * FTerrainHeights
+ *
+ * One height per grid vertex, stored as floats or as 16-bit values quantized over the
+ * current height range. Positions, UVs and normals all follow from the grid index and the
+ * neighbouring heights, so this is the only per-vertex data a terrain has to keep.
+ */
+class FTerrainHeights
+{
+public:
+	// Takes over a full set of heights, quantizing them to 16 bits if bQuantize is set. The quantized
+	// range leaves headroom above and below the heights so craters rarely have to widen it.
+	void Assign(TArray<float>&& InHeights, bool bQuantize);
+
+	// Hands back the float storage so its allocation can be reused, leaving this empty
+	TArray<float> TakeValues();
+
+	// Drops all heights
+	void Reset();
+
+	// Number of heights stored
+	int32 Num() const { return bQuantized ? Quantized.Num() : Values.Num(); }
+
+	// True if heights are stored as 16-bit values
+	bool IsQuantized() const { return bQuantized; }
+
+	// Height of a grid vertex
+	float Get(int32 Index) const { return bQuantized ? RangeMin + float(Quantized[Index]) * RangeStep : Values[Index]; }
+
+	// Stores the height of a grid vertex; quantized storage widens its range first if Z falls outside it.
+	// Returns true if that re-encoded the whole grid, which can shift every other height by up to
+	// half a step, so anything built from the heights must be refreshed in full.
+	bool Set(int32 Index, float Z);
+
+	// Bytes held by the storage
+	SIZE_T GetAllocatedSize() const { return Values.GetAllocatedSize() + Quantized.GetAllocatedSize(); }
+
+private:
+	// Fraction of the height range reserved on each side whenever the quantized range is chosen
+	static constexpr float RangeHeadroom = 0.25f;
+
+	// Re-encodes Source over [Min, Max]
+	void Quantize(TConstArrayView<float> Source, float Min, float Max);
+
+	// Float storage, used when not quantized
+	TArray<float> Values;
+
+	// 16-bit storage, used when quantized
+	TArray<uint16> Quantized;
+
+	// Height of quantized value 0 and the height step per quantized unit
+	float RangeMin = 0.f;
+	float RangeStep = 0.f;
+
+	bool bQuantized = false;
+};
+
+/**
+ * FTerrainBuildParams
+ *
+ * Snapshot of every actor property generation reads, taken on the game thread so the
+ * build itself never touches the actor.
+ */
+struct FTerrainBuildParams
+{
+	// Global grid coordinate of vertex (0, 0); non-zero for streamed chunks
+	FIntPoint Origin = FIntPoint::ZeroValue;
+
+	// Number of grid quads along each axis
+	int32 XSize = 0;
+	int32 YSize = 0;
+
+	// Distance between adjacent grid vertices
+	float Scale = 1.f;
+
+	// UV coordinate scale factor
+	float UVScale = 1.f;
+
+	// Height multiplier applied to the noise
+	float ZMultiplier = 1.f;
+
+	// Sampling scale of the single-octave noise path
+	float NoiseScale = 1.f;
+
+	// Number of grid quads along each side of a chunk
+	int32 ChunkSize = 64;
+
+	// Use the fractal noise kernel instead of single-octave noise
+	bool bUseFractalNoise = false;
+
+	// Fractal noise controls
+	FTerrainNoiseSettings Noise;
+
+	// Fractal octaves finer than this many noise cycles per grid spacing are skipped, and the rest
+	// keep their full-sum weights; 0 evaluates every octave. Only coarse streamed chunks set it.
+	float OctaveCullCycles = 0.f;
+
+	// Depth of the skirt hung off every chunk border; 0 builds chunks without skirts
+	float SkirtDepth = 0.f;
+
+	// Reads heights from the on-disk cache when possible, and writes them there after generating
+	bool bUseHeightCache = false;
+
+	// Stores heights as 16-bit values instead of floats
+	bool bQuantizeHeights = false;
+
+	// Writes slope and height based splat weights into the vertex colors
+	bool bSplatColors = false;
+
+	// Slope, in degrees from flat, over which grass blends into rock
+	float RockSlopeStart = 30.f;
+	float RockSlopeEnd = 45.f;
+
+	// Local-space height where flat ground turns to snow, and the height band it blends over
+	float SnowHeight = 500.f;
+	float SnowBlend = 100.f;
+};
+
+/**
+ * FTerrainBuildData
+ *
+ * Everything one terrain build produces: the height grid plus the chunk layout, whose section
+ * buffers are built as each chunk is uploaded. Vertex positions, UVs and normals are derived
+ * from the heights on demand.
+ */
+struct FTerrainBuildData
+{
+	// Parameters the data was generated from
+	FTerrainBuildParams Params;
+
+	// Height per grid vertex, (XSize + 1) x (YSize + 1), row-major in X
+	FTerrainHeights Heights;
+
+	// Chunks the grid is split into, one mesh section each
+	TArray<FTerrainChunk> Chunks;
+
+	// Number of chunks along each axis
+	int32 NumChunksX = 0;
+	int32 NumChunksY = 0;
+
+	// True if the heights were loaded from the on-disk cache instead of generated
+	bool bFromHeightCache = false;
+
+	// Index of a grid vertex in the height grid
+	int32 GetVertexIndex(int32 X, int32 Y) const { return X * (Params.YSize + 1) + Y; }
+
+	// Grid coordinate of a height grid index
+	FIntPoint GetVertexCoord(int32 Index) const { return FIntPoint(Index / (Params.YSize + 1), Index % (Params.YSize + 1)); }
+
+	// Height of a grid vertex
+	float GetHeight(int32 X, int32 Y) const { return Heights.Get(GetVertexIndex(X, Y)); }
+
+	// Bytes held by the heights and every chunk's buffers
+	SIZE_T GetAllocatedSize() const
+	{
+		SIZE_T Bytes = Heights.GetAllocatedSize() + Chunks.GetAllocatedSize();
+		for (const FTerrainChunk& Chunk : Chunks)
+		{
+			Bytes += Chunk.LODs.GetAllocatedSize();
+			for (const FTerrainChunkMesh& Mesh : Chunk.LODs)
+			{
+				Bytes += Mesh.GetAllocatedSize();
+			}
+		}
+		return Bytes;
+	}
+
+	// Actor-space position of a grid vertex
+	FVector GetVertex(int32 X, int32 Y) const
+	{
+		return FVector((Params.Origin.X + X) * Params.Scale, (Params.Origin.Y + Y) * Params.Scale, GetHeight(X, Y));
+	}
+
+	// UV coordinate of a grid vertex
+	FVector2D GetUV(int32 X, int32 Y) const
+	{
+		return FVector2D((Params.Origin.X + X) * Params.UVScale, (Params.Origin.Y + Y) * Params.UVScale);
+	}
+
+	// Normal and tangent from central height differences (one-sided on the grid edges)
+	void GetNormalAndTangent(int32 X, int32 Y, FVector& OutNormal, FProcMeshTangent& OutTangent) const;
+
+	// Bilinearly interpolated height at a fractional grid position (in vertices from this grid's
+	// first vertex), and optionally the normal of the bilinear surface there. Returns false
+	// outside the grid.
+	bool SampleBilinear(const FVector2D& GridXY, float& OutZ, FVector* OutNormal = nullptr) const;
+};
+
+/**
+ * FTerrainStreamedChunk
+ *
+ * A chunk generated around a player in streaming mode. Entries are recycled through a pool,
+ * keeping both their mesh section index and their buffer allocations.
+ */
+struct FTerrainStreamedChunk
+{
+	// Chunk coordinate, in units of ChunkSize quads
+	FIntPoint Coord = FIntPoint::ZeroValue;
+
+	// Level of detail the chunk was generated at; its grid spacing is Scale * (1 << LOD)
+	int32 LOD = 0;
+
+	// The chunk's grid (with a one-vertex apron) and its single section
+	FTerrainBuildData Data;
+};
+
+/**
+ * FTerrainBuildJob
+ *
+ * An in-flight asynchronous build. The game thread sets bCancelled to abandon it; the
+ * worker checks the flag between stages.
+ */
+struct FTerrainBuildJob
+{
+	FTerrainBuildData Data;
+	std::atomic<bool> bCancelled { false };
+};
+
+/**
+ * TerrainBuild
+ *
+ * Generation stages. They only read and write the FTerrainBuildData passed in, so they are
+ * safe to run on worker threads.
+ */
+namespace TerrainBuild
+{
+	// Generates the height of every grid vertex from noise
+	void GenerateHeights(const FTerrainBuildParams& Params, const FTerrainNoiseTable& Table, TArray<float>& OutHeights);
+
+	// Splits the vertex grid into chunks and assigns their mesh sections
+	void CreateChunks(FTerrainBuildData& Data);
+
+	// Triangle indices for an NumX x NumY vertex grid, plus its skirt if bSkirt is set. Built once
+	// per layout and shared by every chunk that uses it; safe to call from any thread.
+	TSharedRef<const TArray<int32>, ESPMode::ThreadSafe> GetSharedTriangles(int32 NumX, int32 NumY, bool bSkirt);
+
+	// Generates the chunk's vertex and index buffers for a level of detail, sizing Chunk.LODs as needed
+	void BuildChunkLOD(const FTerrainBuildData& Data, FTerrainChunk& Chunk, int32 LOD);
+
+	// Refreshes the vertex attributes of an already built level of detail from the heights in a single
+	// pass that writes position, normal, tangent, UV and splat color per vertex; indices are kept
+	void FillChunkVertices(const FTerrainBuildData& Data, const FTerrainChunk& Chunk, int32 LOD, FTerrainChunkMesh& Mesh);
+
+	// Refreshes only the vertices of an already filled level of detail that sample grid points inside
+	// Rect (inclusive), e.g. around a crater; the caller grows the moved area by the ring whose normals
+	// changed. Falls back to a full fill if Mesh does not match the level's layout. Returns false if
+	// no sampled vertex lies inside Rect, so the section needs no upload.
+	bool FillChunkVertices(const FTerrainBuildData& Data, const FTerrainChunk& Chunk, int32 LOD, FTerrainChunkMesh& Mesh, const FIntRect& Rect);
+
+	// Generates one streamed chunk at ChunkCoord (in units of Params.ChunkSize quads) into Data,
+	// reusing whatever buffers Data already holds. Data.Params supplies everything but the extent.
+	// LOD > 0 generates every (1 << LOD)th vertex only, skipping octaves finer than OctaveCullCycles;
+	// ChunkSize must be a multiple of 1 << LOD.
+	void BuildStreamedChunk(FTerrainBuildData& Data, const FTerrainNoiseTable& Table, const FIntPoint& ChunkCoord, int32 SectionIndex, int32 LOD = 0, float OctaveCullCycles = 0.f);
+
+	// Generates the heights and lays out the chunks. Chunk buffers are not built; call BuildChunkLOD
+	// for each chunk when it is needed. Returns false if bCancelled was raised part way through.
+	// Fractal heights go through OctaveCache when one is given, reusing its unchanged octaves.
+	bool Run(FTerrainBuildData& Data, const FTerrainNoiseTable& Table, const std::atomic<bool>* bCancelled = nullptr, FTerrainOctaveCache* OctaveCache = nullptr);
+}
@@ -0,0 +1,185 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TerrainDeformJournal.h"
+#include "TerrainBuild.h"
+#include "TerrainHeightCache.h"                  // Generation key the journal is tagged with
+#include "Misc/Compression.h"                    // Compressed network snapshots
+#include "Serialization/MemoryReader.h"          // Reading saved journals
+#include "Serialization/MemoryWriter.h"          // Writing journals into save data
+#include "ProfilingDebugging/CpuProfilerTrace.h" // Named CPU scopes for Unreal Insights
+
+namespace TerrainDeformJournal
+{
+	// "TDJR"
+	static constexpr uint32 FileMagic = 0x54444A52;
+
+	// Bump whenever the serialized layout changes
+	static constexpr uint32 FormatVersion = 1;
+
+	// Largest journal Decompress accepts, so a corrupt size prefix cannot trigger a huge allocation
+	static constexpr int32 MaxUncompressedSize = 64 * 1024 * 1024;
+}
+
+void FTerrainDeformJournal::Add(int32 Index, float Delta)
+{
+	Deltas.FindOrAdd(Index) += Delta;
+}
+
+FIntRect FTerrainDeformJournal::Apply(FTerrainHeights& Heights, const FTerrainBuildParams& Params, float Sign) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FTerrainDeformJournal::Apply);
+
+	FIntRect Moved(FIntPoint(MAX_int32, MAX_int32), FIntPoint(MIN_int32, MIN_int32));
+	const int32 RowLength = Params.YSize + 1;
+	bool bReencoded = false;
+
+	for (const TPair<int32, float>& Pair : Deltas)
+	{
+		if (Pair.Key < 0 || Pair.Key >= Heights.Num())
+		{
+			continue;
+		}
+
+		bReencoded |= Heights.Set(Pair.Key, Heights.Get(Pair.Key) + Sign * Pair.Value);
+
+		const FIntPoint GridPoint(Pair.Key / RowLength, Pair.Key % RowLength);
+		Moved.Min = Moved.Min.ComponentMin(GridPoint);
+		Moved.Max = Moved.Max.ComponentMax(GridPoint);
+	}
+
+	if (bReencoded)
+	{
+		return FIntRect(0, 0, Params.XSize, Params.YSize);
+	}
+	return Moved;
+}
+
+void FTerrainDeformJournal::Save(const FTerrainBuildParams& Params, TArray<uint8>& OutBytes) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FTerrainDeformJournal::Save);
+
+	OutBytes.Reset();
+	FMemoryWriter Writer(OutBytes);
+
+	uint32 Magic = TerrainDeformJournal::FileMagic;
+	uint32 Version = TerrainDeformJournal::FormatVersion;
+	uint64 Key = TerrainHeightCache::GetKey(Params);
+	int32 NumDeltas = Deltas.Num();
+	Writer << Magic << Version << Key << NumDeltas;
+
+	// Sorted indices are written as gaps from the previous one, which pack into a byte or two
+	// for the clustered vertices a crater touches
+	TArray<int32> Indices;
+	Deltas.GetKeys(Indices);
+	Indices.Sort();
+
+	int32 Previous = -1;
+	for (const int32 Index : Indices)
+	{
+		uint32 Gap = uint32(Index - Previous);
+		float Delta = Deltas.FindChecked(Index);
+		Writer.SerializeIntPacked(Gap);
+		Writer << Delta;
+		Previous = Index;
+	}
+}
+
+bool FTerrainDeformJournal::Load(const FTerrainBuildParams& Params, TConstArrayView<uint8> Bytes)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FTerrainDeformJournal::Load);
+
+	FMemoryReaderView Reader(MakeArrayView(Bytes.GetData(), Bytes.Num()));
+
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	uint64 Key = 0;
+	int32 NumDeltas = 0;
+	Reader << Magic << Version << Key << NumDeltas;
+
+	const int32 NumVertices = (Params.XSize + 1) * (Params.YSize + 1);
+	if (Reader.IsError() || Magic != TerrainDeformJournal::FileMagic || Version != TerrainDeformJournal::FormatVersion
+		|| Key != TerrainHeightCache::GetKey(Params) || NumDeltas < 0 || NumDeltas > NumVertices)
+	{
+		return false;
+	}
+
+	TMap<int32, float> Loaded;
+	Loaded.Reserve(NumDeltas);
+
+	int64 Index = -1;
+	for (int32 i = 0; i < NumDeltas; i++)
+	{
+		uint32 Gap = 0;
+		float Delta = 0.f;
+		Reader.SerializeIntPacked(Gap);
+		Reader << Delta;
+
+		Index += Gap;
+		if (Reader.IsError() || Gap == 0 || Index >= NumVertices)
+		{
+			return false;
+		}
+		Loaded.Add(int32(Index), Delta);
+	}
+
+	Deltas = MoveTemp(Loaded);
+	return true;
+}
+
+// Layout: int32 uncompressed size, then the zlib stream, or the raw bytes if compression would not
+// shrink them (flagged by a negated size)
+void FTerrainDeformJournal::Compress(TConstArrayView<uint8> Bytes, TArray<uint8>& OutCompressed)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FTerrainDeformJournal::Compress);
+
+	const int32 Bound = FCompression::CompressMemoryBound(NAME_Zlib, Bytes.Num());
+	OutCompressed.SetNumUninitialized(sizeof(int32) + Bound);
+
+	int32 SizePrefix = Bytes.Num();
+	int32 CompressedSize = Bound;
+	if (!FCompression::CompressMemory(NAME_Zlib, OutCompressed.GetData() + sizeof(int32), CompressedSize, Bytes.GetData(), Bytes.Num())
+		|| CompressedSize >= Bytes.Num())
+	{
+		SizePrefix = -Bytes.Num() - 1;
+		CompressedSize = Bytes.Num();
+		FMemory::Memcpy(OutCompressed.GetData() + sizeof(int32), Bytes.GetData(), Bytes.Num());
+	}
+
+	FMemory::Memcpy(OutCompressed.GetData(), &SizePrefix, sizeof(int32));
+	OutCompressed.SetNum(sizeof(int32) + CompressedSize);
+}
+
+bool FTerrainDeformJournal::Decompress(TConstArrayView<uint8> Compressed, TArray<uint8>& OutBytes)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FTerrainDeformJournal::Decompress);
+
+	if (Compressed.Num() < int32(sizeof(int32)))
+	{
+		return false;
+	}
+
+	int32 SizePrefix = 0;
+	FMemory::Memcpy(&SizePrefix, Compressed.GetData(), sizeof(int32));
+
+	const uint8* Payload = Compressed.GetData() + sizeof(int32);
+	const int32 PayloadSize = Compressed.Num() - sizeof(int32);
+
+	// Stored raw
+	if (SizePrefix < 0)
+	{
+		if (-(SizePrefix + 1) != PayloadSize)
+		{
+			return false;
+		}
+		OutBytes = TArray<uint8>(Payload, PayloadSize);
+		return true;
+	}
+
+	if (SizePrefix > TerrainDeformJournal::MaxUncompressedSize)
+	{
+		return false;
+	}
+
+	OutBytes.SetNumUninitialized(SizePrefix);
+	return FCompression::UncompressMemory(NAME_Zlib, OutBytes.GetData(), SizePrefix, Payload, PayloadSize);
+}
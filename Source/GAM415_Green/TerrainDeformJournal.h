@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FTerrainBuildParams;
+class FTerrainHeights;
+
+/**
+ * FTerrainDeformJournal
+ *
+ * Net height change of every grid vertex a deformation has moved since the terrain was
+ * generated. Repeated impacts on the same spot fold into the same entries, so the journal
+ * never holds more than one delta per grid vertex no matter how long a session runs.
+ * Serialized as delta-coded vertex indices in grid order plus one float per vertex, tagged
+ * with the generation key so it is only ever applied to the terrain it was recorded on.
+ */
+class FTerrainDeformJournal
+{
+public:
+	// Adds Delta to the net change recorded for a grid vertex
+	void Add(int32 Index, float Delta);
+
+	// Drops every recorded change
+	void Reset() { Deltas.Reset(); }
+
+	// Number of grid vertices with a recorded change
+	int32 Num() const { return Deltas.Num(); }
+
+	// Bytes held by the recorded changes
+	SIZE_T GetAllocatedSize() const { return Deltas.GetAllocatedSize(); }
+
+	// Adds every recorded change to Heights (or removes it when Sign is -1) and returns the
+	// inclusive grid rectangle they span, or the whole grid if the heights had to be re-encoded;
+	// empty (Min > Max) if there is nothing to apply
+	FIntRect Apply(FTerrainHeights& Heights, const FTerrainBuildParams& Params, float Sign = 1.f) const;
+
+	// Writes the journal for a terrain generated from Params
+	void Save(const FTerrainBuildParams& Params, TArray<uint8>& OutBytes) const;
+
+	// Replaces the journal with one written by Save. Returns false, leaving the journal untouched,
+	// if the bytes are malformed or were recorded on a terrain generated from other parameters.
+	bool Load(const FTerrainBuildParams& Params, TConstArrayView<uint8> Bytes);
+
+	// Zlib-compresses serialized journal bytes, prefixed with their uncompressed size
+	static void Compress(TConstArrayView<uint8> Bytes, TArray<uint8>& OutCompressed);
+
+	// Reverses Compress. Returns false if the data is malformed.
+	static bool Decompress(TConstArrayView<uint8> Compressed, TArray<uint8>& OutBytes);
+
+private:
+	// Net height change per grid vertex index
+	TMap<int32, float> Deltas;
+};
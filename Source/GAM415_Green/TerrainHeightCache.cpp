@@ -0,0 +1,197 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TerrainHeightCache.h"
+#include "TerrainBuild.h"
+#include "Async/MappedFileHandle.h"              // Memory-mapped reads of cache files
+#include "HAL/FileManager.h"                     // Writing, moving and deleting cache files
+#include "HAL/PlatformFileManager.h"             // Platform file layer for mapped and plain reads
+#include "Hash/CityHash.h"                       // Parameter hashing
+#include "Misc/Paths.h"                          // Saved/ directory
+#include "ProfilingDebugging/CpuProfilerTrace.h" // Named CPU scopes for Unreal Insights
+
+namespace TerrainHeightCache
+{
+	// Bump whenever the file layout or the height pipeline around the noise changes. Changes to
+	// the noise itself bump TerrainNoise::KernelRevision, which is part of every key.
+	static constexpr uint32 FormatVersion = 2;
+
+	// "THGT", also rejects files written with the other byte order
+	static constexpr uint32 FileMagic = 0x54484754;
+
+	// Fixed-size header in front of the height data. 32 bytes keeps the floats 4-byte aligned.
+	struct FFileHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+		uint64 Key;
+		int32 XSize;
+		int32 YSize;
+		int32 NumHeights;
+		uint32 Reserved;
+	};
+	static_assert(sizeof(FFileHeader) == 32, "Cache header layout changed; bump FormatVersion");
+
+	// Packs each field explicitly so struct padding never reaches the hash
+	template <typename T>
+	static void Append(TArray<uint8>& Bytes, const T& Value)
+	{
+		Bytes.Append(reinterpret_cast<const uint8*>(&Value), sizeof(T));
+	}
+
+	uint64 GetKey(const FTerrainBuildParams& Params)
+	{
+		TArray<uint8> Bytes;
+		Append(Bytes, FormatVersion);
+		Append(Bytes, TerrainNoise::KernelRevision);
+		Append(Bytes, Params.Origin.X);
+		Append(Bytes, Params.Origin.Y);
+		Append(Bytes, Params.XSize);
+		Append(Bytes, Params.YSize);
+		Append(Bytes, Params.Scale);
+		Append(Bytes, Params.ZMultiplier);
+		Append(Bytes, uint8(Params.bUseFractalNoise));
+
+		// Only the path actually used to generate heights contributes to the key
+		if (Params.bUseFractalNoise)
+		{
+			const FTerrainNoiseSettings& Noise = Params.Noise;
+			Append(Bytes, Noise.Seed);
+			Append(Bytes, uint8(Noise.Type));
+			Append(Bytes, Noise.Octaves);
+			Append(Bytes, Noise.Frequency);
+			Append(Bytes, Noise.Lacunarity);
+			Append(Bytes, Noise.Persistence);
+			Append(Bytes, uint8(Noise.bRidge));
+			Append(Bytes, uint8(Noise.bBillow));
+			Append(Bytes, Params.OctaveCullCycles);
+		}
+		else
+		{
+			Append(Bytes, Params.NoiseScale);
+		}
+
+		return CityHash64(reinterpret_cast<const char*>(Bytes.GetData()), Bytes.Num());
+	}
+
+	FString GetFilename(const FTerrainBuildParams& Params)
+	{
+		return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("TerrainCache"), FString::Printf(TEXT("%016llx.theights"), GetKey(Params)));
+	}
+
+	// True if a header was written for Params by this format version
+	static bool IsValidHeader(const FFileHeader& Header, const FTerrainBuildParams& Params, uint64 Key, int32 NumHeights)
+	{
+		return Header.Magic == FileMagic && Header.Version == FormatVersion && Header.Key == Key
+			&& Header.XSize == Params.XSize && Header.YSize == Params.YSize && Header.NumHeights == NumHeights;
+	}
+
+	// Only a failed size or header check marks a file stale; a file that cannot be mapped is read
+	// into memory instead, so platforms without mapping still hit the cache
+	bool Read(const FTerrainBuildParams& Params, TFunctionRef<void(const float* Heights)> Visit)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(TerrainHeightCache::Read);
+
+		const FString Filename = GetFilename(Params);
+		const uint64 Key = GetKey(Params);
+		const int32 NumHeights = (Params.XSize + 1) * (Params.YSize + 1);
+		const int64 ExpectedSize = int64(sizeof(FFileHeader)) + int64(NumHeights) * sizeof(float);
+
+		{
+			IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+			const int64 FileSize = PlatformFile.FileSize(*Filename);
+			if (FileSize < 0)
+			{
+				return false;
+			}
+
+			if (FileSize == ExpectedSize)
+			{
+				TUniquePtr<IMappedFileHandle> Handle(PlatformFile.OpenMapped(*Filename));
+				TUniquePtr<IMappedFileRegion> Region(Handle.IsValid() ? Handle->MapRegion(0, ExpectedSize) : nullptr);
+				if (Region.IsValid())
+				{
+					const FFileHeader* Header = reinterpret_cast<const FFileHeader*>(Region->GetMappedPtr());
+					if (IsValidHeader(*Header, Params, Key, NumHeights))
+					{
+						Visit(reinterpret_cast<const float*>(Region->GetMappedPtr() + sizeof(FFileHeader)));
+						return true;
+					}
+				}
+				else
+				{
+					TUniquePtr<IFileHandle> File(PlatformFile.OpenRead(*Filename));
+					FFileHeader Header;
+					if (!File.IsValid() || !File->Read(reinterpret_cast<uint8*>(&Header), sizeof(Header)))
+					{
+						UE_LOG(LogTemp, Verbose, TEXT("Could not read terrain height cache %s"), *Filename);
+						return false;
+					}
+
+					if (IsValidHeader(Header, Params, Key, NumHeights))
+					{
+						TArray<float> Heights;
+						Heights.SetNumUninitialized(NumHeights);
+						if (!File->Read(reinterpret_cast<uint8*>(Heights.GetData()), int64(NumHeights) * sizeof(float)))
+						{
+							UE_LOG(LogTemp, Verbose, TEXT("Could not read terrain height cache %s"), *Filename);
+							return false;
+						}
+
+						Visit(Heights.GetData());
+						return true;
+					}
+				}
+			}
+
+			// The region and handles close at the end of this scope, before the file is deleted
+		}
+
+		UE_LOG(LogTemp, Log, TEXT("Discarding stale terrain height cache %s"), *Filename);
+		IFileManager::Get().Delete(*Filename, false, false, true);
+		return false;
+	}
+
+	bool Write(const FTerrainBuildParams& Params, TConstArrayView<float> Heights)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(TerrainHeightCache::Write);
+
+		if (Heights.Num() != (Params.XSize + 1) * (Params.YSize + 1))
+		{
+			return false;
+		}
+
+		FFileHeader Header;
+		Header.Magic = FileMagic;
+		Header.Version = FormatVersion;
+		Header.Key = GetKey(Params);
+		Header.XSize = Params.XSize;
+		Header.YSize = Params.YSize;
+		Header.NumHeights = Heights.Num();
+		Header.Reserved = 0;
+
+		// Write to a unique temporary file and move it into place, so concurrent servers or test
+		// runs never see a half-written cache
+		const FString Filename = GetFilename(Params);
+		const FString TempFilename = FPaths::CreateTempFilename(*FPaths::GetPath(Filename), TEXT("Terrain"), TEXT(".tmp"));
+
+		TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*TempFilename));
+		if (!Writer.IsValid())
+		{
+			return false;
+		}
+
+		Writer->Serialize(&Header, sizeof(Header));
+		Writer->Serialize(const_cast<float*>(Heights.GetData()), Heights.Num() * sizeof(float));
+		const bool bWritten = Writer->Close() && !Writer->IsError();
+		Writer.Reset();
+
+		if (!bWritten || !IFileManager::Get().Move(*Filename, *TempFilename, true, true, false, true))
+		{
+			UE_LOG(LogTemp, Verbose, TEXT("Could not write terrain height cache %s"), *Filename);
+			IFileManager::Get().Delete(*TempFilename, false, false, true);
+			return false;
+		}
+
+		return true;
+	}
+}
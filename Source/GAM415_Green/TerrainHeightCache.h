@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FTerrainBuildParams;
+
+/**
+ * TerrainHeightCache
+ *
+ * Persistent cache of generated height fields under Saved/TerrainCache. Each file holds the
+ * final vertex heights of one terrain, keyed by a hash of every parameter that affects them,
+ * so terrains spawned again with unchanged settings skip noise generation entirely. Files
+ * are memory-mapped on read where the platform supports it and read into memory otherwise,
+ * and rejected (and deleted) if their size or header does not match the current format
+ * version or the requested parameters.
+ */
+namespace TerrainHeightCache
+{
+	// Stable 64-bit key over every parameter the heights depend on
+	uint64 GetKey(const FTerrainBuildParams& Params);
+
+	// Absolute path of the cache file for Params
+	FString GetFilename(const FTerrainBuildParams& Params);
+
+	// Maps (or reads) the cache file for Params and passes its (XSize + 1) * (YSize + 1) heights to Visit.
+	// The pointer is only valid inside Visit. Returns false if there is no valid file.
+	bool Read(const FTerrainBuildParams& Params, TFunctionRef<void(const float* Heights)> Visit);
+
+	// Writes the heights for Params, replacing any existing file. Returns false on I/O failure.
+	bool Write(const FTerrainBuildParams& Params, TConstArrayView<float> Heights);
+}
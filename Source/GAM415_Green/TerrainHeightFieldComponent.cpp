@@ -0,0 +1,262 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TerrainHeightFieldComponent.h"
+#include "TerrainBuild.h"
+#include "Chaos/ImplicitObjectTransformed.h"     // Wrapper re-created after edits so the body refreshes its bounds
+#include "Chaos/ShapeInstance.h"                 // Per-shape filter and material data
+#include "Engine/Engine.h"                       // Default physical material
+#include "Physics/PhysicsFiltering.h"            // Collision filter data for the shape
+#include "Physics/PhysicsInterfaceCore.h"        // Actor creation and scoped physics writes
+#include "Physics/Experimental/PhysScene_Chaos.h" // Adding the body to the scene
+#include "PhysicalMaterials/PhysicalMaterial.h"      // Chaos material handle of the default material
+#include "PhysicsProxy/SingleParticlePhysicsProxy.h" // Game-thread body API
+#include "ProfilingDebugging/CpuProfilerTrace.h" // Named CPU scopes for Unreal Insights
+
+UTerrainHeightFieldComponent::UTerrainHeightFieldComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+
+	// Collision only; there is nothing to render
+	SetHiddenInGame(true);
+	SetCastShadow(false);
+	SetGenerateOverlapEvents(false);
+	SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+}
+
+// Grid vertex backing a height field sample; steps divide the grid, so every sample is a vertex
+Chaos::FReal UTerrainHeightFieldComponent::SampleHeight(const FTerrainBuildData& Grid, int32 Col, int32 Row, const FIntPoint& InStep)
+{
+	return Chaos::FReal(Grid.GetHeight(Col * InStep.X, Row * InStep.Y));
+}
+
+int32 UTerrainHeightFieldComponent::GetDividingStep(int32 Size, int32 Requested)
+{
+	for (int32 Candidate = FMath::Min(Requested, Size); Candidate > 1; Candidate--)
+	{
+		if (Size % Candidate == 0)
+		{
+			return Candidate;
+		}
+	}
+	return 1;
+}
+
+// Height field columns run along grid X and rows along grid Y, so sample (Col, Row) sits at
+// (Col * Step.X, Row * Step.Y) * Scale in actor space, matching the render mesh. A step that does
+// not divide the grid would put the last sample past the mesh edge, so it is lowered until it does.
+void UTerrainHeightFieldComponent::SetHeights(const FTerrainBuildData& Grid, int32 InStep)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UTerrainHeightFieldComponent::SetHeights);
+
+	ClearHeights();
+
+	if (Grid.Params.XSize <= 0 || Grid.Params.YSize <= 0 || Grid.Heights.Num() == 0)
+	{
+		return;
+	}
+
+	GridSize = FIntPoint(Grid.Params.XSize, Grid.Params.YSize);
+	Step = FIntPoint(GetDividingStep(GridSize.X, FMath::Max(1, InStep)), GetDividingStep(GridSize.Y, FMath::Max(1, InStep)));
+	if (Step != FIntPoint(FMath::Max(1, InStep)))
+	{
+		UE_LOG(LogTemp, Log, TEXT("%s: collision step %d does not divide the %dx%d grid; using %dx%d"),
+			*GetName(), InStep, GridSize.X, GridSize.Y, Step.X, Step.Y);
+	}
+
+	const int32 NumCols = GridSize.X / Step.X + 1;
+	const int32 NumRows = GridSize.Y / Step.Y + 1;
+
+	TArray<Chaos::FReal> Heights;
+	Heights.SetNumUninitialized(NumRows * NumCols);
+
+	Chaos::FReal MinZ = TNumericLimits<Chaos::FReal>::Max();
+	Chaos::FReal MaxZ = TNumericLimits<Chaos::FReal>::Lowest();
+	for (int32 Row = 0; Row < NumRows; Row++)
+	{
+		for (int32 Col = 0; Col < NumCols; Col++)
+		{
+			const Chaos::FReal Z = SampleHeight(Grid, Col, Row, Step);
+			Heights[Row * NumCols + Col] = Z;
+			MinZ = FMath::Min(MinZ, Z);
+			MaxZ = FMath::Max(MaxZ, Z);
+		}
+	}
+
+	const Chaos::FReal SpacingX = Chaos::FReal(Grid.Params.Scale) * Step.X;
+	const Chaos::FReal SpacingY = Chaos::FReal(Grid.Params.Scale) * Step.Y;
+	TArray<uint8> MaterialIndices;
+	MaterialIndices.Add(0);
+
+	HeightField = new Chaos::FHeightField(MoveTemp(Heights), MoveTemp(MaterialIndices), NumRows, NumCols, Chaos::FVec3(SpacingX, SpacingY, 1.0));
+	LocalBounds = FBox(FVector(0.0, 0.0, MinZ), FVector((NumCols - 1) * SpacingX, (NumRows - 1) * SpacingY, MaxZ));
+
+	UpdateBounds();
+	RecreatePhysicsState();
+}
+
+// Edits the covered cells in place, then swaps in a fresh wrapper so the body and the scene's
+// acceleration structure pick up the new bounds
+void UTerrainHeightFieldComponent::UpdateHeights(const FTerrainBuildData& Grid, const FIntRect& GridRect)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UTerrainHeightFieldComponent::UpdateHeights);
+
+	if (!HeightField.IsValid() || GridRect.Max.X < GridRect.Min.X || GridRect.Max.Y < GridRect.Min.Y
+		|| GridSize != FIntPoint(Grid.Params.XSize, Grid.Params.YSize))
+	{
+		return;
+	}
+
+	// Every sample whose grid vertex lies inside the rectangle
+	const int32 NumCols = HeightField->GetNumCols();
+	const int32 NumRows = HeightField->GetNumRows();
+	const int32 BeginCol = FMath::Clamp(FMath::DivideAndRoundUp(GridRect.Min.X, Step.X), 0, NumCols - 1);
+	const int32 BeginRow = FMath::Clamp(FMath::DivideAndRoundUp(GridRect.Min.Y, Step.Y), 0, NumRows - 1);
+	const int32 EndCol = FMath::Clamp(GridRect.Max.X / Step.X, BeginCol, NumCols - 1);
+	const int32 EndRow = FMath::Clamp(GridRect.Max.Y / Step.Y, BeginRow, NumRows - 1);
+
+	const int32 EditCols = EndCol - BeginCol + 1;
+	const int32 EditRows = EndRow - BeginRow + 1;
+
+	TArray<Chaos::FReal> Heights;
+	Heights.SetNumUninitialized(EditRows * EditCols);
+	for (int32 Row = 0; Row < EditRows; Row++)
+	{
+		for (int32 Col = 0; Col < EditCols; Col++)
+		{
+			const Chaos::FReal Z = SampleHeight(Grid, BeginCol + Col, BeginRow + Row, Step);
+			Heights[Row * EditCols + Col] = Z;
+			LocalBounds.Min.Z = FMath::Min(LocalBounds.Min.Z, Z);
+			LocalBounds.Max.Z = FMath::Max(LocalBounds.Max.Z, Z);
+		}
+	}
+
+	FPhysicsActorHandle& ActorHandle = BodyInstance.GetPhysicsActorHandle();
+	if (!FPhysicsInterface::IsValid(ActorHandle))
+	{
+		HeightField->EditHeights(Heights, BeginRow, BeginCol, EditRows, EditCols);
+		return;
+	}
+
+	FPhysicsCommand::ExecuteWrite(ActorHandle, [this, &Heights, BeginRow, BeginCol, EditRows, EditCols](const FPhysicsActorHandle& Actor)
+	{
+		HeightField->EditHeights(Heights, BeginRow, BeginCol, EditRows, EditCols);
+
+		Actor->GetGameThreadAPI().SetGeometry(MakeGeometry());
+
+		if (FPhysScene* PhysScene = GetWorld() ? GetWorld()->GetPhysicsScene() : nullptr)
+		{
+			PhysScene->UpdateActorInAccelerationStructure(Actor);
+		}
+	});
+
+	UpdateBounds();
+}
+
+// Identity-transformed wrapper around the height field; a new wrapper makes Chaos re-read its bounds
+Chaos::FImplicitObjectPtr UTerrainHeightFieldComponent::MakeGeometry() const
+{
+	return Chaos::MakeImplicitObjectPtr<Chaos::TImplicitObjectTransformed<Chaos::FReal, 3>>(
+		Chaos::FImplicitObjectPtr(HeightField.GetReference()), Chaos::FRigidTransform3::Identity);
+}
+
+void UTerrainHeightFieldComponent::ClearHeights()
+{
+	if (HeightField.IsValid())
+	{
+		DestroyPhysicsState();
+		HeightField = nullptr;
+		LocalBounds = FBox(ForceInit);
+		GridSize = FIntPoint::ZeroValue;
+	}
+}
+
+SIZE_T UTerrainHeightFieldComponent::GetHeightFieldMemory() const
+{
+	// Chaos stores one quantized 16-bit height per sample
+	return HeightField.IsValid() ? SIZE_T(HeightField->GetNumRows()) * HeightField->GetNumCols() * sizeof(uint16) : 0;
+}
+
+// Creates a static Chaos body holding the height field, the way landscape collision does
+void UTerrainHeightFieldComponent::OnCreatePhysicsState()
+{
+	// Skip UPrimitiveComponent's body setup path; the body is built by hand below
+	USceneComponent::OnCreatePhysicsState();
+
+	FPhysScene* PhysScene = GetWorld() ? GetWorld()->GetPhysicsScene() : nullptr;
+	if (!HeightField.IsValid() || !PhysScene || BodyInstance.IsValidBodyInstance())
+	{
+		return;
+	}
+
+	// Spacing is baked into the height field, so the body only takes location and rotation
+	const FTransform& ComponentTransform = GetComponentTransform();
+
+	FActorCreationParams Params;
+	Params.InitialTM = FTransform(ComponentTransform.GetRotation(), ComponentTransform.GetTranslation());
+	Params.bQueryOnly = false;
+	Params.bStatic = true;
+	Params.Scene = PhysScene;
+
+	FPhysicsActorHandle PhysHandle;
+	FPhysicsInterface::CreateActor(Params, PhysHandle);
+	Chaos::FRigidBodyHandle_External& Body_External = PhysHandle->GetGameThreadAPI();
+
+	Chaos::FImplicitObjectPtr Geometry = MakeGeometry();
+
+	FCollisionFilterData QueryFilterData;
+	FCollisionFilterData SimFilterData;
+	CreateShapeFilterData(GetCollisionObjectType(), FMaskFilter(0), GetOwner() ? GetOwner()->GetUniqueID() : 0, GetCollisionResponseToChannels(),
+		GetUniqueID(), 0, QueryFilterData, SimFilterData, false, false, true);
+	QueryFilterData.Word3 |= EPDF_SimpleCollision | EPDF_ComplexCollision;
+	SimFilterData.Word3 |= EPDF_SimpleCollision | EPDF_ComplexCollision;
+
+	TUniquePtr<Chaos::FPerShapeData> Shape = Chaos::FShapeInstanceProxy::Make(0, Geometry);
+	Shape->SetQueryData(QueryFilterData);
+	Shape->SetSimData(SimFilterData);
+	Shape->SetMaterials({ GEngine->DefaultPhysMaterial->GetPhysicsMaterial() });
+	Shape->UpdateShapeBounds(Chaos::FRigidTransform3(Body_External.GetX(), Body_External.GetR()));
+
+	Chaos::FShapesArray Shapes;
+	Shapes.Emplace(MoveTemp(Shape));
+
+	TArray<Chaos::FImplicitObjectPtr> Geometries;
+	Geometries.Emplace(MoveTemp(Geometry));
+	Body_External.MergeGeometry(MoveTemp(Geometries));
+	Body_External.MergeShapesArray(MoveTemp(Shapes));
+
+	BodyInstance.PhysicsUserData = FPhysicsUserData(&BodyInstance);
+	BodyInstance.OwnerComponent = this;
+	BodyInstance.ActorHandle = PhysHandle;
+	Body_External.SetUserData(&BodyInstance.PhysicsUserData);
+
+	TArray<FPhysicsActorHandle> Actors;
+	Actors.Add(PhysHandle);
+	FPhysicsCommand::ExecuteWrite(PhysScene, [&Actors, PhysScene]()
+	{
+		PhysScene->AddActorsToScene_AssumesLocked(Actors, true);
+	});
+	PhysScene->AddToComponentMaps(this, PhysHandle);
+}
+
+void UTerrainHeightFieldComponent::OnDestroyPhysicsState()
+{
+	if (FPhysScene* PhysScene = GetWorld() ? GetWorld()->GetPhysicsScene() : nullptr)
+	{
+		FPhysicsActorHandle& ActorHandle = BodyInstance.GetPhysicsActorHandle();
+		if (FPhysicsInterface::IsValid(ActorHandle))
+		{
+			PhysScene->RemoveFromComponentMaps(ActorHandle);
+		}
+	}
+
+	Super::OnDestroyPhysicsState();
+}
+
+FBoxSphereBounds UTerrainHeightFieldComponent::CalcBounds(const FTransform& LocalToWorld) const
+{
+	if (!LocalBounds.IsValid)
+	{
+		return FBoxSphereBounds(LocalToWorld.GetLocation(), FVector::ZeroVector, 0.0);
+	}
+	return FBoxSphereBounds(LocalBounds).TransformBy(LocalToWorld);
+}
@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/PrimitiveComponent.h"
+#include "Chaos/HeightField.h"
+#include "TerrainHeightFieldComponent.generated.h"
+
+struct FTerrainBuildData;
+
+/**
+ * UTerrainHeightFieldComponent
+ *
+ * Collision-only component that backs a terrain grid with a Chaos height field instead of a
+ * cooked triangle mesh. The height field can sample every Step-th grid vertex to trade
+ * precision for memory. The step is lowered per axis to a divisor of the grid size, so the
+ * last samples land exactly on the mesh edge. Deformations patch the affected cells in place
+ * rather than rebuilding or re-cooking anything.
+ */
+UCLASS(ClassGroup=(Terrain))
+class GAM415_GREEN_API UTerrainHeightFieldComponent : public UPrimitiveComponent
+{
+	GENERATED_BODY()
+
+public:
+	UTerrainHeightFieldComponent();
+
+	// Rebuilds the height field from the grid, keeping every Step-th vertex along each axis (or the
+	// largest smaller step that divides that axis)
+	void SetHeights(const FTerrainBuildData& Grid, int32 Step);
+
+	// Copies the grid heights inside an inclusive grid rectangle into the existing height field
+	void UpdateHeights(const FTerrainBuildData& Grid, const FIntRect& GridRect);
+
+	// Drops the height field and its physics body
+	void ClearHeights();
+
+	// Bytes held by the height field geometry
+	SIZE_T GetHeightFieldMemory() const;
+
+protected:
+	virtual void OnCreatePhysicsState() override;
+	virtual void OnDestroyPhysicsState() override;
+	virtual FBoxSphereBounds CalcBounds(const FTransform& LocalToWorld) const override;
+
+private:
+	// Height field geometry shared with the physics body
+	TRefCountPtr<Chaos::FHeightField> HeightField;
+
+	// Grid vertices per height field sample along grid X and Y; each divides its axis' grid size
+	FIntPoint Step = FIntPoint(1, 1);
+
+	// Grid extent the height field was built from, in quads
+	FIntPoint GridSize = FIntPoint::ZeroValue;
+
+	// Local-space bounds of the height field
+	FBox LocalBounds = FBox(ForceInit);
+
+	// Body geometry wrapping HeightField
+	Chaos::FImplicitObjectPtr MakeGeometry() const;
+
+	// Height of height field sample (Col, Row)
+	static Chaos::FReal SampleHeight(const FTerrainBuildData& Grid, int32 Col, int32 Row, const FIntPoint& InStep);
+
+	// Largest step no greater than Requested that divides Size
+	static int32 GetDividingStep(int32 Size, int32 Requested);
+};
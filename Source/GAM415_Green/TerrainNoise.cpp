@@ -0,0 +1,682 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TerrainNoise.h"
+#include "Misc/ScopeLock.h"        // Guards the per-seed table cache
+
+// Pick the widest instruction set the target was compiled for; the scalar path is always available
+#if PLATFORM_ENABLE_VECTORINTRINSICS_NEON
+	#define TERRAIN_NOISE_NEON 1
+	#include <arm_neon.h>
+#elif PLATFORM_ENABLE_VECTORINTRINSICS && PLATFORM_ALWAYS_HAS_AVX_2
+	#define TERRAIN_NOISE_AVX2 1
+	#include <immintrin.h>
+#elif PLATFORM_ENABLE_VECTORINTRINSICS
+	#define TERRAIN_NOISE_SSE 1
+	#include <emmintrin.h>
+#endif
+
+#ifndef TERRAIN_NOISE_NEON
+	#define TERRAIN_NOISE_NEON 0
+#endif
+#ifndef TERRAIN_NOISE_AVX2
+	#define TERRAIN_NOISE_AVX2 0
+#endif
+#ifndef TERRAIN_NOISE_SSE
+	#define TERRAIN_NOISE_SSE 0
+#endif
+
+#define TERRAIN_NOISE_SIMD (TERRAIN_NOISE_SSE || TERRAIN_NOISE_AVX2 || TERRAIN_NOISE_NEON)
+
+namespace TerrainNoise
+{
+	// 16 evenly spaced unit directions; written out so no platform sin/cos is involved
+	static const float UnitDirections[16][2] =
+	{
+		{ 1.f, 0.f }, { 0.92387953f, 0.38268343f }, { 0.70710678f, 0.70710678f }, { 0.38268343f, 0.92387953f },
+		{ 0.f, 1.f }, { -0.38268343f, 0.92387953f }, { -0.70710678f, 0.70710678f }, { -0.92387953f, 0.38268343f },
+		{ -1.f, 0.f }, { -0.92387953f, -0.38268343f }, { -0.70710678f, -0.70710678f }, { -0.38268343f, -0.92387953f },
+		{ 0.f, -1.f }, { 0.38268343f, -0.92387953f }, { 0.70710678f, -0.70710678f }, { 0.92387953f, -0.38268343f },
+	};
+
+	// Unit gradients put 2D Perlin in [-sqrt(0.5), sqrt(0.5)]; rescale to roughly [-1, 1]
+	static constexpr float PerlinScale = 1.41421356f;
+
+	// Simplex skew factors and output scale for unit gradients
+	static constexpr float SimplexF2 = 0.36602540f;  // (sqrt(3) - 1) / 2
+	static constexpr float SimplexG2 = 0.21132487f;  // (3 - sqrt(3)) / 6
+	static constexpr float SimplexScale = 99.f;
+
+	static FORCEINLINE float Fade(float T)
+	{
+		return T * T * T * (T * (T * 6.f - 15.f) + 10.f);
+	}
+
+	// Contribution of one simplex corner; zero outside its radius
+	static FORCEINLINE float SimplexCorner(const FTerrainNoiseTable& Table, int32 Hash, float X, float Y)
+	{
+		const float T = FMath::Max(0.5f - X * X - Y * Y, 0.f);
+		const float T2 = T * T;
+		return T2 * T2 * (Table.GradX[Hash] * X + Table.GradY[Hash] * Y);
+	}
+}
+
+FTerrainNoiseTable::FTerrainNoiseTable(int32 InSeed)
+	: Seed(InSeed)
+{
+	// xorshift32 seeded from the terrain seed; must never start at zero
+	uint32 State = uint32(InSeed) * 0x9E3779B9u ^ 0x85EBCA6Bu;
+	State = State ? State : 1u;
+	auto Next = [&State]()
+	{
+		State ^= State << 13;
+		State ^= State >> 17;
+		State ^= State << 5;
+		return State;
+	};
+
+	for (int32 i = 0; i < 256; i++)
+	{
+		Perm[i] = i;
+	}
+
+	// Fisher-Yates shuffle
+	for (int32 i = 255; i > 0; i--)
+	{
+		Swap(Perm[i], Perm[Next() % uint32(i + 1)]);
+	}
+
+	for (int32 i = 0; i < 256; i++)
+	{
+		Perm[i + 256] = Perm[i];
+
+		const uint32 Direction = Next() & 15u;
+		GradX[i] = TerrainNoise::UnitDirections[Direction][0];
+		GradY[i] = TerrainNoise::UnitDirections[Direction][1];
+
+		Values[i] = float(Next() & 0xFFFFu) * (2.f / 65535.f) - 1.f;
+	}
+
+	// Basis statistics over a 32 x 32 spread of points that never lands on lattice corners
+	for (int32 Type = 0; Type < 3; Type++)
+	{
+		double Sum = 0.0, AbsSum = 0.0;
+		for (int32 i = 0; i < 32; i++)
+		{
+			for (int32 j = 0; j < 32; j++)
+			{
+				const float N = Sample(ETerrainNoiseType(Type), (i + 0.5f) * 0.731f, (j + 0.5f) * 0.577f);
+				Sum += N;
+				AbsSum += FMath::Abs(N);
+			}
+		}
+		MeanSample[Type] = float(Sum / 1024.0);
+		MeanAbsSample[Type] = float(AbsSum / 1024.0);
+	}
+}
+
+float FTerrainNoiseTable::Perlin2D(float X, float Y) const
+{
+	const float FloorX = FMath::FloorToFloat(X);
+	const float FloorY = FMath::FloorToFloat(Y);
+	const int32 Xi = int32(FloorX) & 255;
+	const int32 Yi = int32(FloorY) & 255;
+
+	X -= FloorX;
+	Y -= FloorY;
+
+	const int32 H00 = Perm[Perm[Xi] + Yi];
+	const int32 H10 = Perm[Perm[Xi + 1] + Yi];
+	const int32 H01 = Perm[Perm[Xi] + Yi + 1];
+	const int32 H11 = Perm[Perm[Xi + 1] + Yi + 1];
+
+	const float D00 = GradX[H00] * X + GradY[H00] * Y;
+	const float D10 = GradX[H10] * (X - 1.f) + GradY[H10] * Y;
+	const float D01 = GradX[H01] * X + GradY[H01] * (Y - 1.f);
+	const float D11 = GradX[H11] * (X - 1.f) + GradY[H11] * (Y - 1.f);
+
+	const float U = TerrainNoise::Fade(X);
+	const float V = TerrainNoise::Fade(Y);
+	return FMath::Lerp(FMath::Lerp(D00, D10, U), FMath::Lerp(D01, D11, U), V) * TerrainNoise::PerlinScale;
+}
+
+float FTerrainNoiseTable::Simplex2D(float X, float Y) const
+{
+	using namespace TerrainNoise;
+
+	// Skew into simplex space to find the containing cell
+	const float S = (X + Y) * SimplexF2;
+	const float I = FMath::FloorToFloat(X + S);
+	const float J = FMath::FloorToFloat(Y + S);
+	const float T = (I + J) * SimplexG2;
+
+	const float X0 = X - (I - T);
+	const float Y0 = Y - (J - T);
+
+	// Which of the two triangles of the cell the point is in
+	const float I1 = X0 > Y0 ? 1.f : 0.f;
+	const float J1 = 1.f - I1;
+
+	const float X1 = X0 - I1 + SimplexG2;
+	const float Y1 = Y0 - J1 + SimplexG2;
+	const float X2 = X0 - 1.f + 2.f * SimplexG2;
+	const float Y2 = Y0 - 1.f + 2.f * SimplexG2;
+
+	const int32 Ii = int32(I) & 255;
+	const int32 Ji = int32(J) & 255;
+
+	const int32 H0 = Perm[Ii + Perm[Ji]];
+	const int32 H1 = Perm[Ii + int32(I1) + Perm[Ji + int32(J1)]];
+	const int32 H2 = Perm[Ii + 1 + Perm[Ji + 1]];
+
+	return (SimplexCorner(*this, H0, X0, Y0) + SimplexCorner(*this, H1, X1, Y1) + SimplexCorner(*this, H2, X2, Y2)) * SimplexScale;
+}
+
+float FTerrainNoiseTable::Value2D(float X, float Y) const
+{
+	const float FloorX = FMath::FloorToFloat(X);
+	const float FloorY = FMath::FloorToFloat(Y);
+	const int32 Xi = int32(FloorX) & 255;
+	const int32 Yi = int32(FloorY) & 255;
+
+	const float U = TerrainNoise::Fade(X - FloorX);
+	const float V = TerrainNoise::Fade(Y - FloorY);
+
+	const float V00 = Values[Perm[Perm[Xi] + Yi]];
+	const float V10 = Values[Perm[Perm[Xi + 1] + Yi]];
+	const float V01 = Values[Perm[Perm[Xi] + Yi + 1]];
+	const float V11 = Values[Perm[Perm[Xi + 1] + Yi + 1]];
+
+	return FMath::Lerp(FMath::Lerp(V00, V10, U), FMath::Lerp(V01, V11, U), V);
+}
+
+float FTerrainNoiseTable::Sample(ETerrainNoiseType Type, float X, float Y) const
+{
+	switch (Type)
+	{
+	case ETerrainNoiseType::Simplex: return Simplex2D(X, Y);
+	case ETerrainNoiseType::Value:   return Value2D(X, Y);
+	default:                         return Perlin2D(X, Y);
+	}
+}
+
+namespace TerrainNoise
+{
+	TSharedRef<const FTerrainNoiseTable, ESPMode::ThreadSafe> GetTable(int32 Seed)
+	{
+		static FCriticalSection CacheLock;
+		static TMap<int32, TSharedRef<const FTerrainNoiseTable, ESPMode::ThreadSafe>> Cache;
+
+		FScopeLock Lock(&CacheLock);
+		if (const TSharedRef<const FTerrainNoiseTable, ESPMode::ThreadSafe>* Existing = Cache.Find(Seed))
+		{
+			return *Existing;
+		}
+		return Cache.Add(Seed, MakeShared<const FTerrainNoiseTable, ESPMode::ThreadSafe>(Seed));
+	}
+
+	float Fractal2D(const FTerrainNoiseTable& Table, const FTerrainNoiseSettings& Settings, float X, float Y)
+	{
+		float Amp = 1.f, Freq = Settings.Frequency, Sum = 0.f, Norm = 0.f;
+		for (int32 Oct = 0; Oct < Settings.Octaves; ++Oct)
+		{
+			const float Sample = Table.Sample(Settings.Type, X * Freq, Y * Freq);
+			float N = Sample;
+			if (Settings.bRidge) { N = 1.f - FMath::Abs(Sample); }
+			else if (Settings.bBillow) { N = FMath::Abs(Sample); }
+			Sum += N * Amp; Norm += Amp; Amp *= Settings.Persistence; Freq *= Settings.Lacunarity;
+		}
+		return (Norm > KINDA_SMALL_NUMBER) ? (Sum / Norm) : 0.f;
+	}
+
+	int32 GetResolvedOctaves(const FTerrainNoiseSettings& Settings, float SampleSpacing, float MaxCyclesPerSample)
+	{
+		if (Settings.Octaves <= 1)
+		{
+			return Settings.Octaves;
+		}
+
+		int32 NumOctaves = 1;
+		float Freq = Settings.Frequency * Settings.Lacunarity;
+		while (NumOctaves < Settings.Octaves && Freq * SampleSpacing <= MaxCyclesPerSample)
+		{
+			NumOctaves++;
+			Freq *= Settings.Lacunarity;
+		}
+		return NumOctaves;
+	}
+
+	void GetCulledOctaveCorrection(const FTerrainNoiseTable& Table, const FTerrainNoiseSettings& Settings, int32 NumOctaves, float& OutScale, float& OutBias)
+	{
+		// Expected value of one folded octave, folded the same way Fractal2D folds it
+		const int32 TypeIndex = int32(Settings.Type);
+		const float FoldMean = Settings.bRidge ? 1.f - Table.MeanAbsSample[TypeIndex]
+			: Settings.bBillow ? Table.MeanAbsSample[TypeIndex] : Table.MeanSample[TypeIndex];
+
+		float Amp = 1.f, KeptNorm = 0.f, FullNorm = 0.f;
+		for (int32 Oct = 0; Oct < Settings.Octaves; ++Oct)
+		{
+			FullNorm += Amp;
+			if (Oct < NumOctaves)
+			{
+				KeptNorm += Amp;
+			}
+			Amp *= Settings.Persistence;
+		}
+
+		OutScale = FullNorm > KINDA_SMALL_NUMBER ? KeptNorm / FullNorm : 1.f;
+		OutBias = FullNorm > KINDA_SMALL_NUMBER ? FoldMean * (FullNorm - KeptNorm) / FullNorm : 0.f;
+	}
+
+	// How each octave is folded before it is summed; fixed for a whole build
+	enum class EFold : uint8
+	{
+		None,
+		Ridge,
+		Billow
+	};
+
+	template <ETerrainNoiseType Type>
+	static FORCEINLINE float SampleBasis(const FTerrainNoiseTable& Table, float X, float Y)
+	{
+		if constexpr (Type == ETerrainNoiseType::Simplex) { return Table.Simplex2D(X, Y); }
+		else if constexpr (Type == ETerrainNoiseType::Value) { return Table.Value2D(X, Y); }
+		else { return Table.Perlin2D(X, Y); }
+	}
+
+	template <EFold Fold>
+	static FORCEINLINE float FoldOctave(float N)
+	{
+		if constexpr (Fold == EFold::Ridge) { return 1.f - FMath::Abs(N); }
+		else if constexpr (Fold == EFold::Billow) { return FMath::Abs(N); }
+		else { return N; }
+	}
+
+	// Per-octave frequency and weight of a fractal sum, computed once per row in the same order
+	// Fractal2D uses so the kernels match it
+	struct FOctaves
+	{
+		TArray<float, TInlineAllocator<16>> Frequencies;
+		TArray<float, TInlineAllocator<16>> Weights;
+
+		explicit FOctaves(const FTerrainNoiseSettings& Settings)
+		{
+			float Amp = 1.f, Freq = Settings.Frequency, Norm = 0.f;
+			for (int32 Oct = 0; Oct < Settings.Octaves; ++Oct)
+			{
+				Frequencies.Add(Freq);
+				Weights.Add(Amp);
+				Norm += Amp; Amp *= Settings.Persistence; Freq *= Settings.Lacunarity;
+			}
+
+			// Fold the normalisation into the weights so each sample ends with the sum
+			for (float& Weight : Weights)
+			{
+				Weight /= Norm;
+			}
+		}
+	};
+
+	// Scalar fractal sum; NumOctaves is a compile-time constant in the specialized kernels, so the
+	// loop unrolls, and the basis and fold are resolved at compile time either way
+	template <ETerrainNoiseType Type, EFold Fold, int32 FixedOctaves>
+	static FORCEINLINE float FractalSample(const FTerrainNoiseTable& Table, const FOctaves& Octaves, float X, float Y)
+	{
+		const int32 NumOctaves = FixedOctaves > 0 ? FixedOctaves : Octaves.Weights.Num();
+
+		float Sum = 0.f;
+		for (int32 Oct = 0; Oct < NumOctaves; ++Oct)
+		{
+			const float Freq = Octaves.Frequencies[Oct];
+			Sum += FoldOctave<Fold>(SampleBasis<Type>(Table, X * Freq, Y * Freq)) * Octaves.Weights[Oct];
+		}
+		return Sum;
+	}
+
+	// === SIMD back ends ===
+	// Each back end exposes the same small set of lane-wise operations; the kernels below are
+	// written once against that interface.
+
+#if TERRAIN_NOISE_SSE
+	struct FOps
+	{
+		static constexpr int32 Width = 4;
+		using FFloat = __m128;
+		using FInt = __m128i;
+
+		static FORCEINLINE FFloat Load(const float* Ptr) { return _mm_loadu_ps(Ptr); }
+		static FORCEINLINE void Store(float* Ptr, FFloat V) { _mm_storeu_ps(Ptr, V); }
+		static FORCEINLINE FFloat Set(float V) { return _mm_set1_ps(V); }
+		static FORCEINLINE FInt SetInt(int32 V) { return _mm_set1_epi32(V); }
+		static FORCEINLINE FFloat Add(FFloat A, FFloat B) { return _mm_add_ps(A, B); }
+		static FORCEINLINE FFloat Sub(FFloat A, FFloat B) { return _mm_sub_ps(A, B); }
+		static FORCEINLINE FFloat Mul(FFloat A, FFloat B) { return _mm_mul_ps(A, B); }
+		static FORCEINLINE FFloat Max(FFloat A, FFloat B) { return _mm_max_ps(A, B); }
+		static FORCEINLINE FFloat Abs(FFloat A) { return _mm_andnot_ps(_mm_set1_ps(-0.f), A); }
+		static FORCEINLINE FFloat Floor(FFloat A)
+		{
+			// SSE2 has no floor; truncate and step down where truncation rounded up
+			const FFloat T = _mm_cvtepi32_ps(_mm_cvttps_epi32(A));
+			return _mm_sub_ps(T, _mm_and_ps(_mm_cmpgt_ps(T, A), _mm_set1_ps(1.f)));
+		}
+		static FORCEINLINE FInt Greater(FFloat A, FFloat B) { return _mm_castps_si128(_mm_cmpgt_ps(A, B)); }
+		static FORCEINLINE FFloat Select(FInt Mask, FFloat A, FFloat B)
+		{
+			const FFloat M = _mm_castsi128_ps(Mask);
+			return _mm_or_ps(_mm_and_ps(M, A), _mm_andnot_ps(M, B));
+		}
+		static FORCEINLINE FInt ToInt(FFloat A) { return _mm_cvttps_epi32(A); }
+		static FORCEINLINE FInt And(FInt A, FInt B) { return _mm_and_si128(A, B); }
+		static FORCEINLINE FInt AddInt(FInt A, FInt B) { return _mm_add_epi32(A, B); }
+		static FORCEINLINE FInt Gather(const int32* Table, FInt Index)
+		{
+			alignas(16) int32 Lanes[4];
+			_mm_store_si128(reinterpret_cast<__m128i*>(Lanes), Index);
+			return _mm_setr_epi32(Table[Lanes[0]], Table[Lanes[1]], Table[Lanes[2]], Table[Lanes[3]]);
+		}
+		static FORCEINLINE FFloat Gather(const float* Table, FInt Index)
+		{
+			alignas(16) int32 Lanes[4];
+			_mm_store_si128(reinterpret_cast<__m128i*>(Lanes), Index);
+			return _mm_setr_ps(Table[Lanes[0]], Table[Lanes[1]], Table[Lanes[2]], Table[Lanes[3]]);
+		}
+	};
+#elif TERRAIN_NOISE_AVX2
+	struct FOps
+	{
+		static constexpr int32 Width = 8;
+		using FFloat = __m256;
+		using FInt = __m256i;
+
+		static FORCEINLINE FFloat Load(const float* Ptr) { return _mm256_loadu_ps(Ptr); }
+		static FORCEINLINE void Store(float* Ptr, FFloat V) { _mm256_storeu_ps(Ptr, V); }
+		static FORCEINLINE FFloat Set(float V) { return _mm256_set1_ps(V); }
+		static FORCEINLINE FInt SetInt(int32 V) { return _mm256_set1_epi32(V); }
+		static FORCEINLINE FFloat Add(FFloat A, FFloat B) { return _mm256_add_ps(A, B); }
+		static FORCEINLINE FFloat Sub(FFloat A, FFloat B) { return _mm256_sub_ps(A, B); }
+		static FORCEINLINE FFloat Mul(FFloat A, FFloat B) { return _mm256_mul_ps(A, B); }
+		static FORCEINLINE FFloat Max(FFloat A, FFloat B) { return _mm256_max_ps(A, B); }
+		static FORCEINLINE FFloat Abs(FFloat A) { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), A); }
+		static FORCEINLINE FFloat Floor(FFloat A) { return _mm256_floor_ps(A); }
+		static FORCEINLINE FInt Greater(FFloat A, FFloat B) { return _mm256_castps_si256(_mm256_cmp_ps(A, B, _CMP_GT_OQ)); }
+		static FORCEINLINE FFloat Select(FInt Mask, FFloat A, FFloat B) { return _mm256_blendv_ps(B, A, _mm256_castsi256_ps(Mask)); }
+		static FORCEINLINE FInt ToInt(FFloat A) { return _mm256_cvttps_epi32(A); }
+		static FORCEINLINE FInt And(FInt A, FInt B) { return _mm256_and_si256(A, B); }
+		static FORCEINLINE FInt AddInt(FInt A, FInt B) { return _mm256_add_epi32(A, B); }
+		static FORCEINLINE FInt Gather(const int32* Table, FInt Index) { return _mm256_i32gather_epi32(Table, Index, 4); }
+		static FORCEINLINE FFloat Gather(const float* Table, FInt Index) { return _mm256_i32gather_ps(Table, Index, 4); }
+	};
+#elif TERRAIN_NOISE_NEON
+	struct FOps
+	{
+		static constexpr int32 Width = 4;
+		using FFloat = float32x4_t;
+		using FInt = int32x4_t;
+
+		static FORCEINLINE FFloat Load(const float* Ptr) { return vld1q_f32(Ptr); }
+		static FORCEINLINE void Store(float* Ptr, FFloat V) { vst1q_f32(Ptr, V); }
+		static FORCEINLINE FFloat Set(float V) { return vdupq_n_f32(V); }
+		static FORCEINLINE FInt SetInt(int32 V) { return vdupq_n_s32(V); }
+		static FORCEINLINE FFloat Add(FFloat A, FFloat B) { return vaddq_f32(A, B); }
+		static FORCEINLINE FFloat Sub(FFloat A, FFloat B) { return vsubq_f32(A, B); }
+		static FORCEINLINE FFloat Mul(FFloat A, FFloat B) { return vmulq_f32(A, B); }
+		static FORCEINLINE FFloat Max(FFloat A, FFloat B) { return vmaxq_f32(A, B); }
+		static FORCEINLINE FFloat Abs(FFloat A) { return vabsq_f32(A); }
+		static FORCEINLINE FFloat Floor(FFloat A) { return vrndmq_f32(A); }
+		static FORCEINLINE FInt Greater(FFloat A, FFloat B) { return vreinterpretq_s32_u32(vcgtq_f32(A, B)); }
+		static FORCEINLINE FFloat Select(FInt Mask, FFloat A, FFloat B) { return vbslq_f32(vreinterpretq_u32_s32(Mask), A, B); }
+		static FORCEINLINE FInt ToInt(FFloat A) { return vcvtq_s32_f32(A); }
+		static FORCEINLINE FInt And(FInt A, FInt B) { return vandq_s32(A, B); }
+		static FORCEINLINE FInt AddInt(FInt A, FInt B) { return vaddq_s32(A, B); }
+		static FORCEINLINE FInt Gather(const int32* Table, FInt Index)
+		{
+			alignas(16) int32 Lanes[4];
+			vst1q_s32(Lanes, Index);
+			const int32 Values[4] = { Table[Lanes[0]], Table[Lanes[1]], Table[Lanes[2]], Table[Lanes[3]] };
+			return vld1q_s32(Values);
+		}
+		static FORCEINLINE FFloat Gather(const float* Table, FInt Index)
+		{
+			alignas(16) int32 Lanes[4];
+			vst1q_s32(Lanes, Index);
+			const float Values[4] = { Table[Lanes[0]], Table[Lanes[1]], Table[Lanes[2]], Table[Lanes[3]] };
+			return vld1q_f32(Values);
+		}
+	};
+#endif
+
+#if TERRAIN_NOISE_SIMD
+	using FFloat = FOps::FFloat;
+	using FInt = FOps::FInt;
+
+	static FORCEINLINE FFloat FadeWide(FFloat T)
+	{
+		const FFloat Inner = FOps::Add(FOps::Mul(T, FOps::Sub(FOps::Mul(T, FOps::Set(6.f)), FOps::Set(15.f))), FOps::Set(10.f));
+		return FOps::Mul(FOps::Mul(FOps::Mul(T, T), T), Inner);
+	}
+
+	static FORCEINLINE FFloat LerpWide(FFloat A, FFloat B, FFloat Alpha)
+	{
+		return FOps::Add(A, FOps::Mul(Alpha, FOps::Sub(B, A)));
+	}
+
+	// Dot product of the per-seed gradient for each lane's hash with (X, Y)
+	static FORCEINLINE FFloat GradWide(const FTerrainNoiseTable& Table, FInt Hash, FFloat X, FFloat Y)
+	{
+		return FOps::Add(FOps::Mul(FOps::Gather(Table.GradX, Hash), X), FOps::Mul(FOps::Gather(Table.GradY, Hash), Y));
+	}
+
+	// Hashes of the four corners of each lane's grid cell, in the same order as the scalar code
+	static FORCEINLINE void CornerHashesWide(const FTerrainNoiseTable& Table, FInt Xi, FInt Yi, FInt& H00, FInt& H10, FInt& H01, FInt& H11)
+	{
+		const FInt One = FOps::SetInt(1);
+		const FInt A = FOps::Gather(Table.Perm, Xi);
+		const FInt B = FOps::Gather(Table.Perm, FOps::AddInt(Xi, One));
+		H00 = FOps::Gather(Table.Perm, FOps::AddInt(A, Yi));
+		H10 = FOps::Gather(Table.Perm, FOps::AddInt(B, Yi));
+		H01 = FOps::Gather(Table.Perm, FOps::AddInt(FOps::AddInt(A, Yi), One));
+		H11 = FOps::Gather(Table.Perm, FOps::AddInt(FOps::AddInt(B, Yi), One));
+	}
+
+	static FORCEINLINE FFloat Perlin2DWide(const FTerrainNoiseTable& Table, FFloat X, FFloat Y)
+	{
+		const FInt Mask = FOps::SetInt(255);
+		const FFloat One = FOps::Set(1.f);
+
+		const FFloat FloorX = FOps::Floor(X);
+		const FFloat FloorY = FOps::Floor(Y);
+		const FInt Xi = FOps::And(FOps::ToInt(FloorX), Mask);
+		const FInt Yi = FOps::And(FOps::ToInt(FloorY), Mask);
+
+		X = FOps::Sub(X, FloorX);
+		Y = FOps::Sub(Y, FloorY);
+		const FFloat X1 = FOps::Sub(X, One);
+		const FFloat Y1 = FOps::Sub(Y, One);
+
+		FInt H00, H10, H01, H11;
+		CornerHashesWide(Table, Xi, Yi, H00, H10, H01, H11);
+
+		const FFloat U = FadeWide(X);
+		const FFloat V = FadeWide(Y);
+		const FFloat Result = LerpWide(
+			LerpWide(GradWide(Table, H00, X, Y), GradWide(Table, H10, X1, Y), U),
+			LerpWide(GradWide(Table, H01, X, Y1), GradWide(Table, H11, X1, Y1), U), V);
+		return FOps::Mul(Result, FOps::Set(PerlinScale));
+	}
+
+	static FORCEINLINE FFloat SimplexCornerWide(const FTerrainNoiseTable& Table, FInt Hash, FFloat X, FFloat Y)
+	{
+		const FFloat T = FOps::Max(FOps::Sub(FOps::Sub(FOps::Set(0.5f), FOps::Mul(X, X)), FOps::Mul(Y, Y)), FOps::Set(0.f));
+		const FFloat T2 = FOps::Mul(T, T);
+		return FOps::Mul(FOps::Mul(T2, T2), GradWide(Table, Hash, X, Y));
+	}
+
+	static FORCEINLINE FFloat Simplex2DWide(const FTerrainNoiseTable& Table, FFloat X, FFloat Y)
+	{
+		const FInt Mask = FOps::SetInt(255);
+		const FInt OneI = FOps::SetInt(1);
+		const FFloat One = FOps::Set(1.f);
+		const FFloat G2 = FOps::Set(SimplexG2);
+
+		const FFloat S = FOps::Mul(FOps::Add(X, Y), FOps::Set(SimplexF2));
+		const FFloat I = FOps::Floor(FOps::Add(X, S));
+		const FFloat J = FOps::Floor(FOps::Add(Y, S));
+		const FFloat T = FOps::Mul(FOps::Add(I, J), G2);
+
+		const FFloat X0 = FOps::Sub(X, FOps::Sub(I, T));
+		const FFloat Y0 = FOps::Sub(Y, FOps::Sub(J, T));
+
+		const FFloat I1 = FOps::Select(FOps::Greater(X0, Y0), One, FOps::Set(0.f));
+		const FFloat J1 = FOps::Sub(One, I1);
+
+		const FFloat X1 = FOps::Add(FOps::Sub(X0, I1), G2);
+		const FFloat Y1 = FOps::Add(FOps::Sub(Y0, J1), G2);
+		const FFloat X2 = FOps::Add(FOps::Sub(X0, One), FOps::Set(2.f * SimplexG2));
+		const FFloat Y2 = FOps::Add(FOps::Sub(Y0, One), FOps::Set(2.f * SimplexG2));
+
+		const FInt Ii = FOps::And(FOps::ToInt(I), Mask);
+		const FInt Ji = FOps::And(FOps::ToInt(J), Mask);
+
+		const FInt H0 = FOps::Gather(Table.Perm, FOps::AddInt(Ii, FOps::Gather(Table.Perm, Ji)));
+		const FInt H1 = FOps::Gather(Table.Perm, FOps::AddInt(FOps::AddInt(Ii, FOps::ToInt(I1)), FOps::Gather(Table.Perm, FOps::AddInt(Ji, FOps::ToInt(J1)))));
+		const FInt H2 = FOps::Gather(Table.Perm, FOps::AddInt(FOps::AddInt(Ii, OneI), FOps::Gather(Table.Perm, FOps::AddInt(Ji, OneI))));
+
+		const FFloat Sum = FOps::Add(FOps::Add(SimplexCornerWide(Table, H0, X0, Y0), SimplexCornerWide(Table, H1, X1, Y1)), SimplexCornerWide(Table, H2, X2, Y2));
+		return FOps::Mul(Sum, FOps::Set(SimplexScale));
+	}
+
+	static FORCEINLINE FFloat Value2DWide(const FTerrainNoiseTable& Table, FFloat X, FFloat Y)
+	{
+		const FInt Mask = FOps::SetInt(255);
+
+		const FFloat FloorX = FOps::Floor(X);
+		const FFloat FloorY = FOps::Floor(Y);
+		const FInt Xi = FOps::And(FOps::ToInt(FloorX), Mask);
+		const FInt Yi = FOps::And(FOps::ToInt(FloorY), Mask);
+
+		FInt H00, H10, H01, H11;
+		CornerHashesWide(Table, Xi, Yi, H00, H10, H01, H11);
+
+		const FFloat U = FadeWide(FOps::Sub(X, FloorX));
+		const FFloat V = FadeWide(FOps::Sub(Y, FloorY));
+		return LerpWide(
+			LerpWide(FOps::Gather(Table.Values, H00), FOps::Gather(Table.Values, H10), U),
+			LerpWide(FOps::Gather(Table.Values, H01), FOps::Gather(Table.Values, H11), U), V);
+	}
+
+	template <ETerrainNoiseType Type>
+	static FORCEINLINE FFloat SampleBasisWide(const FTerrainNoiseTable& Table, FFloat X, FFloat Y)
+	{
+		if constexpr (Type == ETerrainNoiseType::Simplex) { return Simplex2DWide(Table, X, Y); }
+		else if constexpr (Type == ETerrainNoiseType::Value) { return Value2DWide(Table, X, Y); }
+		else { return Perlin2DWide(Table, X, Y); }
+	}
+
+	template <EFold Fold>
+	static FORCEINLINE FFloat FoldOctaveWide(FFloat N)
+	{
+		if constexpr (Fold == EFold::Ridge) { return FOps::Sub(FOps::Set(1.f), FOps::Abs(N)); }
+		else if constexpr (Fold == EFold::Billow) { return FOps::Abs(N); }
+		else { return N; }
+	}
+#endif
+
+	// Row kernel for one basis, fold and octave count (0 = read from the settings). Evaluates
+	// FOps::Width samples per iteration where SIMD is available, then finishes the row in scalar.
+	template <ETerrainNoiseType Type, EFold Fold, int32 FixedOctaves>
+	static void Fractal2DRowKernel(const FTerrainNoiseTable& Table, const FTerrainNoiseSettings& Settings, FVector2f Start, FVector2f Step, int32 Count, float* Out)
+	{
+		const FOctaves Octaves(Settings);
+		const int32 NumOctaves = FixedOctaves > 0 ? FixedOctaves : Octaves.Weights.Num();
+		int32 Done = 0;
+
+#if TERRAIN_NOISE_SIMD
+		const int32 NumWide = Count - Count % FOps::Width;
+
+		float LaneOffsets[FOps::Width];
+		for (int32 Lane = 0; Lane < FOps::Width; Lane++)
+		{
+			LaneOffsets[Lane] = float(Lane);
+		}
+		const FFloat LaneIndex = FOps::Load(LaneOffsets);
+
+		for (int32 Base = 0; Base < NumWide; Base += FOps::Width)
+		{
+			const FFloat Index = FOps::Add(FOps::Set(float(Base)), LaneIndex);
+			const FFloat X = FOps::Add(FOps::Set(Start.X), FOps::Mul(Index, FOps::Set(Step.X)));
+			const FFloat Y = FOps::Add(FOps::Set(Start.Y), FOps::Mul(Index, FOps::Set(Step.Y)));
+
+			FFloat Sum = FOps::Set(0.f);
+			for (int32 Oct = 0; Oct < NumOctaves; ++Oct)
+			{
+				const FFloat FreqV = FOps::Set(Octaves.Frequencies[Oct]);
+				const FFloat N = FoldOctaveWide<Fold>(SampleBasisWide<Type>(Table, FOps::Mul(X, FreqV), FOps::Mul(Y, FreqV)));
+				Sum = FOps::Add(Sum, FOps::Mul(N, FOps::Set(Octaves.Weights[Oct])));
+			}
+
+			FOps::Store(Out + Base, Sum);
+		}
+
+		Done = NumWide;
+#endif
+
+		// Remainder that does not fill a whole vector, or everything without SIMD
+		for (int32 i = Done; i < Count; i++)
+		{
+			Out[i] = FractalSample<Type, Fold, FixedOctaves>(Table, Octaves, Start.X + float(i) * Step.X, Start.Y + float(i) * Step.Y);
+		}
+	}
+
+	// No octaves sum to zero, as in Fractal2D
+	static void ZeroRowKernel(const FTerrainNoiseTable& Table, const FTerrainNoiseSettings& Settings, FVector2f Start, FVector2f Step, int32 Count, float* Out)
+	{
+		FMemory::Memzero(Out, Count * sizeof(float));
+	}
+
+	// Octave counts the UI offers by default get an unrolled kernel each; anything else shares
+	// the kernel that reads the count at run time
+	template <ETerrainNoiseType Type, EFold Fold>
+	static FRowKernel SelectOctaveKernel(int32 Octaves)
+	{
+		switch (Octaves)
+		{
+		case 1:  return &Fractal2DRowKernel<Type, Fold, 1>;
+		case 2:  return &Fractal2DRowKernel<Type, Fold, 2>;
+		case 3:  return &Fractal2DRowKernel<Type, Fold, 3>;
+		case 4:  return &Fractal2DRowKernel<Type, Fold, 4>;
+		case 5:  return &Fractal2DRowKernel<Type, Fold, 5>;
+		case 6:  return &Fractal2DRowKernel<Type, Fold, 6>;
+		case 7:  return &Fractal2DRowKernel<Type, Fold, 7>;
+		case 8:  return &Fractal2DRowKernel<Type, Fold, 8>;
+		default: return &Fractal2DRowKernel<Type, Fold, 0>;
+		}
+	}
+
+	// Ridge wins over billow, matching Fractal2D
+	template <ETerrainNoiseType Type>
+	static FRowKernel SelectFoldKernel(const FTerrainNoiseSettings& Settings)
+	{
+		if (Settings.bRidge) { return SelectOctaveKernel<Type, EFold::Ridge>(Settings.Octaves); }
+		if (Settings.bBillow) { return SelectOctaveKernel<Type, EFold::Billow>(Settings.Octaves); }
+		return SelectOctaveKernel<Type, EFold::None>(Settings.Octaves);
+	}
+
+	FRowKernel GetRowKernel(const FTerrainNoiseSettings& Settings)
+	{
+		if (Settings.Octaves <= 0)
+		{
+			return &ZeroRowKernel;
+		}
+
+		switch (Settings.Type)
+		{
+		case ETerrainNoiseType::Simplex: return SelectFoldKernel<ETerrainNoiseType::Simplex>(Settings);
+		case ETerrainNoiseType::Value:   return SelectFoldKernel<ETerrainNoiseType::Value>(Settings);
+		default:                         return SelectFoldKernel<ETerrainNoiseType::Perlin>(Settings);
+		}
+	}
+
+	void Fractal2DRow(const FTerrainNoiseTable& Table, const FTerrainNoiseSettings& Settings, FVector2f Start, FVector2f Step, int32 Count, float* Out)
+	{
+		GetRowKernel(Settings)(Table, Settings, Start, Step, Count, Out);
+	}
+}
@@ -0,0 +1,137 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TerrainNoise.generated.h"
+
+// Basis function summed by the fractal noise
+UENUM(BlueprintType)
+enum class ETerrainNoiseType : uint8
+{
+	// Classic gradient noise on a square grid (4 corners per sample)
+	Perlin,
+
+	// Gradient noise on a simplex grid (3 corners per sample, fewer axis-aligned artifacts)
+	Simplex,
+
+	// Interpolated random values (cheapest, blockier)
+	Value
+};
+
+/**
+ * FTerrainNoiseSettings
+ *
+ * Fractal noise parameters that stay fixed for a whole terrain build.
+ */
+struct FTerrainNoiseSettings
+{
+	// Seed the permutation and gradient tables are built from
+	int32 Seed = 0;
+
+	// Basis function for every octave
+	ETerrainNoiseType Type = ETerrainNoiseType::Perlin;
+
+	// Number of noise layers summed together
+	int32 Octaves = 1;
+
+	// Sampling frequency of the first octave
+	float Frequency = 1.f;
+
+	// Frequency multiplier between octaves
+	float Lacunarity = 2.f;
+
+	// Amplitude multiplier between octaves
+	float Persistence = 0.5f;
+
+	// Folds each octave into sharp ridges (1 - |n|)
+	bool bRidge = false;
+
+	// Folds each octave into rounded billows (|n|); ignored when bRidge is set
+	bool bBillow = false;
+};
+
+/**
+ * FTerrainNoiseTable
+ *
+ * Permutation, gradient and value tables for one seed. Built with integer arithmetic only,
+ * so the same seed produces the same tables, and the same heights, on every platform.
+ * Tables are immutable once built and can be shared freely between threads.
+ */
+class GAM415_GREEN_API FTerrainNoiseTable
+{
+public:
+	explicit FTerrainNoiseTable(int32 InSeed);
+
+	int32 GetSeed() const { return Seed; }
+
+	// 2D gradient noise, roughly [-1, 1]
+	float Perlin2D(float X, float Y) const;
+
+	// 2D simplex noise, roughly [-1, 1]
+	float Simplex2D(float X, float Y) const;
+
+	// 2D value noise, [-1, 1]
+	float Value2D(float X, float Y) const;
+
+	// Samples the basis selected by Type
+	float Sample(ETerrainNoiseType Type, float X, float Y) const;
+
+	// Permutation of 0..255 repeated twice so (hash + 1) lookups never wrap
+	int32 Perm[512];
+
+	// Unit gradient per hash value
+	float GradX[256];
+	float GradY[256];
+
+	// Random value in [-1, 1] per hash value
+	float Values[256];
+
+	// Mean of each basis, and of its absolute value, over a spread of sample points; indexed by
+	// ETerrainNoiseType. A culled fractal sum adds these in place of the octaves it skips.
+	float MeanSample[3];
+	float MeanAbsSample[3];
+
+private:
+	int32 Seed;
+};
+
+/**
+ * TerrainNoise
+ *
+ * Fractal sums of the seeded 2D noise. The scalar functions are the reference
+ * implementation; the row kernels evaluate a whole row of samples at once with SSE, AVX2
+ * or NEON depending on what the target was compiled for, and fall back to scalar code
+ * everywhere else. Each kernel is a template instantiation for one basis and fold mode, so
+ * neither is tested per sample.
+ */
+namespace TerrainNoise
+{
+	// Revision of the generated values. Bump it whenever a change to the tables, bases or kernels
+	// alters the noise for unchanged settings, so heights cached on disk are regenerated.
+	inline constexpr uint32 KernelRevision = 2;
+
+	// Shared table for a seed, built on first use and cached for later builds
+	GAM415_GREEN_API TSharedRef<const FTerrainNoiseTable, ESPMode::ThreadSafe> GetTable(int32 Seed);
+
+	// Fractal sum of Settings.Octaves octaves of the selected basis at (X, Y)
+	GAM415_GREEN_API float Fractal2D(const FTerrainNoiseTable& Table, const FTerrainNoiseSettings& Settings, float X, float Y);
+
+	// Writes Fractal2D(Start + i * Step) to Out[i] for i in [0, Count), for one fixed basis, fold and octave count
+	using FRowKernel = void (*)(const FTerrainNoiseTable& Table, const FTerrainNoiseSettings& Settings, FVector2f Start, FVector2f Step, int32 Count, float* Out);
+
+	// Row kernel compiled for Settings' basis, fold mode and (for 1 to 8) octave count. Look it up
+	// once per build and call it for every row.
+	GAM415_GREEN_API FRowKernel GetRowKernel(const FTerrainNoiseSettings& Settings);
+
+	// Number of leading octaves whose frequency stays within MaxCyclesPerSample noise cycles per
+	// SampleSpacing. Always at least one, and never more than Settings.Octaves.
+	GAM415_GREEN_API int32 GetResolvedOctaves(const FTerrainNoiseSettings& Settings, float SampleSpacing, float MaxCyclesPerSample);
+
+	// Scale and bias that turn the fractal sum of only the first NumOctaves octaves into an estimate
+	// of the full sum: kept octaves get back their full-sum weight, and skipped ones add their mean
+	GAM415_GREEN_API void GetCulledOctaveCorrection(const FTerrainNoiseTable& Table, const FTerrainNoiseSettings& Settings, int32 NumOctaves, float& OutScale, float& OutBias);
+
+	// Writes Fractal2D(Start + i * Step) to Out[i] for i in [0, Count); picks the kernel on every call
+	GAM415_GREEN_API void Fractal2DRow(const FTerrainNoiseTable& Table, const FTerrainNoiseSettings& Settings, FVector2f Start, FVector2f Step, int32 Count, float* Out);
+}
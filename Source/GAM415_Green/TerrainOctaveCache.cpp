@@ -0,0 +1,175 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TerrainOctaveCache.h"
+#include "TerrainBuild.h"
+#include "Async/ParallelFor.h"                   // Evaluates and sums layers across worker threads
+#include "Misc/ScopeLock.h"                      // Guards the cached layers
+#include "ProfilingDebugging/CpuProfilerTrace.h" // Named CPU scopes for Unreal Insights
+
+// Octave frequencies and weights are stepped exactly as the fractal kernels step them. Layers are
+// matched on the octave index and the bits of Frequency and Lacunarity, never on the float
+// frequency, so reuse does not depend on the stepped frequency coming out identical.
+bool FTerrainOctaveCache::GenerateHeights(const FTerrainBuildParams& Params, const FTerrainNoiseTable& Table, TArray<float>& OutHeights, const std::atomic<bool>* bCancelled)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FTerrainOctaveCache::GenerateHeights);
+
+	auto IsCancelled = [bCancelled]() { return bCancelled && bCancelled->load(std::memory_order_relaxed); };
+
+	FGridKey GridKey;
+	GridKey.Seed = Table.GetSeed();
+	GridKey.Type = Params.Noise.Type;
+	GridKey.bRidge = Params.Noise.bRidge;
+	GridKey.bBillow = Params.Noise.bBillow;
+	GridKey.Origin = Params.Origin;
+	GridKey.XSize = Params.XSize;
+	GridKey.YSize = Params.YSize;
+	GridKey.Scale = Params.Scale;
+
+	const int32 RowLength = Params.YSize + 1;
+	const int32 NumVertices = (Params.XSize + 1) * RowLength;
+
+	// Copy the reusable layers out so the lock is not held while evaluating
+	TArray<FLayer> Cached;
+	{
+		FScopeLock ScopeLock(&Lock);
+		if (Key == GridKey)
+		{
+			Cached = Layers;
+		}
+	}
+
+	// A single octave at weight 1 is exactly one unweighted layer; the basis and fold stay fixed
+	// across octaves, so one kernel serves them all
+	FTerrainNoiseSettings LayerSettings = Params.Noise;
+	LayerSettings.Octaves = 1;
+	const TerrainNoise::FRowKernel LayerKernel = TerrainNoise::GetRowKernel(LayerSettings);
+
+	TArray<FLayer> Used;
+	TArray<float> Weights;
+	float Amp = 1.f, Freq = Params.Noise.Frequency, Norm = 0.f;
+	int32 NumEvaluated = 0;
+
+	for (int32 Oct = 0; Oct < Params.Noise.Octaves; ++Oct)
+	{
+		const FLayerKey LayerKey(Oct, Params.Noise.Frequency, Params.Noise.Lacunarity);
+		const FLayer* Found = Cached.FindByPredicate([&LayerKey](const FLayer& Layer) { return Layer.Key == LayerKey; });
+		if (Found)
+		{
+			Used.Add(*Found);
+		}
+		else
+		{
+			if (IsCancelled()) { return false; }
+
+			TSharedRef<TArray<float>, ESPMode::ThreadSafe> Values = MakeShared<TArray<float>, ESPMode::ThreadSafe>();
+			Values->SetNumUninitialized(NumVertices);
+			LayerSettings.Frequency = Freq;
+
+			float* LayerData = Values->GetData();
+			ParallelFor(Params.XSize + 1, [&Params, &Table, &LayerSettings, LayerKernel, LayerData, RowLength](int32 X)
+			{
+				LayerKernel(Table, LayerSettings, FVector2f((Params.Origin.X + X) * Params.Scale, Params.Origin.Y * Params.Scale),
+					FVector2f(0.f, Params.Scale), RowLength, LayerData + X * RowLength);
+			});
+
+			FLayer& Layer = Used.AddDefaulted_GetRef();
+			Layer.Key = LayerKey;
+			Layer.Values = Values;
+			NumEvaluated++;
+		}
+
+		Weights.Add(Amp);
+		Norm += Amp; Amp *= Params.Noise.Persistence; Freq *= Params.Noise.Lacunarity;
+	}
+
+	if (IsCancelled()) { return false; }
+
+	if (Used.Num() == 0)
+	{
+		OutHeights.SetNumZeroed(NumVertices, EAllowShrinking::No);
+		return true;
+	}
+
+	for (float& Weight : Weights)
+	{
+		Weight /= Norm;
+	}
+
+	// Sum the layers row by row in octave order, the same order the fused kernels use
+	OutHeights.SetNumUninitialized(NumVertices, EAllowShrinking::No);
+	ParallelFor(Params.XSize + 1, [&Params, &Used, &Weights, &OutHeights, RowLength](int32 X)
+	{
+		float* RowHeights = &OutHeights[X * RowLength];
+		const int32 RowStart = X * RowLength;
+
+		const float* First = Used[0].Values->GetData() + RowStart;
+		for (int32 Y = 0; Y < RowLength; Y++)
+		{
+			RowHeights[Y] = First[Y] * Weights[0];
+		}
+
+		for (int32 Oct = 1; Oct < Used.Num(); ++Oct)
+		{
+			const float* LayerRow = Used[Oct].Values->GetData() + RowStart;
+			const float Weight = Weights[Oct];
+			for (int32 Y = 0; Y < RowLength; Y++)
+			{
+				RowHeights[Y] += LayerRow[Y] * Weight;
+			}
+		}
+
+		for (int32 Y = 0; Y < RowLength; Y++)
+		{
+			RowHeights[Y] *= Params.ZMultiplier;
+		}
+	});
+
+	// Keep this build's layers first, then older ones (octaves since removed) while they fit
+	{
+		FScopeLock ScopeLock(&Lock);
+		Key = GridKey;
+		Layers.Reset();
+
+		const int64 LayerBytes = int64(NumVertices) * sizeof(float);
+		int64 Bytes = 0;
+		auto Keep = [this, &Bytes, LayerBytes](const FLayer& Layer)
+		{
+			if (Bytes + LayerBytes > MaxCachedBytes || Layers.ContainsByPredicate([&Layer](const FLayer& Kept) { return Kept.Key == Layer.Key; }))
+			{
+				return;
+			}
+			Layers.Add(Layer);
+			Bytes += LayerBytes;
+		};
+
+		for (const FLayer& Layer : Used)
+		{
+			Keep(Layer);
+		}
+		for (const FLayer& Layer : Cached)
+		{
+			Keep(Layer);
+		}
+	}
+
+	UE_LOG(LogTemp, Verbose, TEXT("FTerrainOctaveCache: evaluated %d of %d octave layers (%d reused)"), NumEvaluated, Used.Num(), Used.Num() - NumEvaluated);
+	return true;
+}
+
+void FTerrainOctaveCache::Reset()
+{
+	FScopeLock ScopeLock(&Lock);
+	Layers.Reset();
+}
+
+int64 FTerrainOctaveCache::GetAllocatedSize() const
+{
+	FScopeLock ScopeLock(&Lock);
+
+	int64 Bytes = Layers.GetAllocatedSize();
+	for (const FLayer& Layer : Layers)
+	{
+		Bytes += Layer.Values->GetAllocatedSize();
+	}
+	return Bytes;
+}
@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TerrainNoise.h"
+#include <atomic>
+
+struct FTerrainBuildParams;
+
+/**
+ * FTerrainOctaveCache
+ *
+ * Keeps the unweighted noise layer of every octave from the last fractal build, so the next
+ * build on the same grid only evaluates the octaves whose frequency changed. The weights,
+ * normalisation and ZMultiplier are applied when the layers are summed. That means editing
+ * Persistence, ZMultiplier or the octave count reuses every existing layer, and editing
+ * Lacunarity reuses the first octave. Used for editor previews, where the same terrain is
+ * rebuilt after every tweak. Safe to share between overlapping builds.
+ */
+class FTerrainOctaveCache
+{
+public:
+	// Writes Params' fractal heights to OutHeights, evaluating only the octave layers not already
+	// cached. Returns false, leaving the cache intact, if bCancelled was raised part way.
+	bool GenerateHeights(const FTerrainBuildParams& Params, const FTerrainNoiseTable& Table, TArray<float>& OutHeights, const std::atomic<bool>* bCancelled = nullptr);
+
+	// Drops every cached layer
+	void Reset();
+
+	// Bytes held by the cached layers
+	int64 GetAllocatedSize() const;
+
+private:
+	// Everything a layer depends on besides its frequency
+	struct FGridKey
+	{
+		int32 Seed = 0;
+		ETerrainNoiseType Type = ETerrainNoiseType::Perlin;
+		bool bRidge = false;
+		bool bBillow = false;
+		FIntPoint Origin = FIntPoint::ZeroValue;
+		int32 XSize = 0;
+		int32 YSize = 0;
+		float Scale = 0.f;
+
+		bool operator==(const FGridKey& Other) const
+		{
+			return Seed == Other.Seed && Type == Other.Type && bRidge == Other.bRidge && bBillow == Other.bBillow
+				&& Origin == Other.Origin && XSize == Other.XSize && YSize == Other.YSize && Scale == Other.Scale;
+		}
+	};
+
+	// Identifies an octave layer by the inputs its frequency is computed from, compared bit for
+	// bit, rather than by the float frequency itself. The first octave does not depend on
+	// Lacunarity, so its key leaves it out.
+	struct FLayerKey
+	{
+		int32 Octave = 0;
+		uint32 FrequencyBits = 0;
+		uint32 LacunarityBits = 0;
+
+		FLayerKey() = default;
+		FLayerKey(int32 InOctave, float Frequency, float Lacunarity)
+			: Octave(InOctave)
+			, FrequencyBits(FMath::AsUInt(Frequency))
+			, LacunarityBits(InOctave > 0 ? FMath::AsUInt(Lacunarity) : 0)
+		{
+		}
+
+		bool operator==(const FLayerKey& Other) const
+		{
+			return Octave == Other.Octave && FrequencyBits == Other.FrequencyBits && LacunarityBits == Other.LacunarityBits;
+		}
+	};
+
+	// One octave evaluated over the whole grid
+	struct FLayer
+	{
+		FLayerKey Key;
+		TSharedPtr<const TArray<float>, ESPMode::ThreadSafe> Values;
+	};
+
+	// Layers are only kept while they fit; later octaves of larger grids are evaluated every time
+	static constexpr int64 MaxCachedBytes = 256 * 1024 * 1024;
+
+	mutable FCriticalSection Lock;
+	FGridKey Key;
+	TArray<FLayer> Layers;
+};
@@ -0,0 +1,34 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TerrainSaveGame.h"
+#include "PerlinProcTerrain.h"
+
+void UTerrainSaveGame::StoreTerrain(APerlinProcTerrain* Terrain)
+{
+	if (!Terrain)
+	{
+		return;
+	}
+
+	const FName TerrainName = Terrain->GetFName();
+	FTerrainSaveRecord* Record = Terrains.FindByPredicate([TerrainName](const FTerrainSaveRecord& Entry) { return Entry.TerrainName == TerrainName; });
+	if (!Record)
+	{
+		Record = &Terrains.AddDefaulted_GetRef();
+		Record->TerrainName = TerrainName;
+	}
+
+	Terrain->SaveDeformations(Record->Journal);
+}
+
+bool UTerrainSaveGame::RestoreTerrain(APerlinProcTerrain* Terrain) const
+{
+	if (!Terrain)
+	{
+		return false;
+	}
+
+	const FName TerrainName = Terrain->GetFName();
+	const FTerrainSaveRecord* Record = Terrains.FindByPredicate([TerrainName](const FTerrainSaveRecord& Entry) { return Entry.TerrainName == TerrainName; });
+	return Record && Terrain->LoadDeformations(Record->Journal);
+}
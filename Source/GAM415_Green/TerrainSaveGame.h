@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/SaveGame.h"
+#include "TerrainSaveGame.generated.h"
+
+class APerlinProcTerrain;
+
+/**
+ * FTerrainSaveRecord
+ *
+ * Saved deformation journal of one terrain actor.
+ */
+USTRUCT(BlueprintType)
+struct FTerrainSaveRecord
+{
+	GENERATED_BODY()
+
+	// Name of the terrain actor in its level
+	UPROPERTY(SaveGame, BlueprintReadOnly, Category="Terrain|Save")
+	FName TerrainName;
+
+	// Bytes written by APerlinProcTerrain::SaveDeformations
+	UPROPERTY(SaveGame)
+	TArray<uint8> Journal;
+};
+
+/**
+ * UTerrainSaveGame
+ *
+ * Save game holding the deformation journals of any number of terrains. Only the net height
+ * changes are stored, so the size of a save is bounded by the number of vertices ever
+ * deformed rather than the number of impacts.
+ */
+UCLASS(BlueprintType)
+class GAM415_GREEN_API UTerrainSaveGame : public USaveGame
+{
+	GENERATED_BODY()
+
+public:
+	// One record per saved terrain
+	UPROPERTY(SaveGame, BlueprintReadOnly, Category="Terrain|Save")
+	TArray<FTerrainSaveRecord> Terrains;
+
+	// Records the terrain's current deformations, replacing any earlier record for it
+	UFUNCTION(BlueprintCallable, Category="Terrain|Save")
+	void StoreTerrain(APerlinProcTerrain* Terrain);
+
+	// Hands the terrain its saved deformations (see APerlinProcTerrain::LoadDeformations).
+	// Returns false if there is no record for it or the terrain rejected the record.
+	UFUNCTION(BlueprintCallable, Category="Terrain|Save")
+	bool RestoreTerrain(APerlinProcTerrain* Terrain) const;
+};
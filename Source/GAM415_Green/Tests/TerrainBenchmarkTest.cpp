@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/AutomationTest.h"
+#include "TerrainBenchmarkCommandlet.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FTerrainBenchmarkTest, "GAM415_Green.Terrain.Benchmark",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+// One test per case of the TerrainBenchmark commandlet's default suite; the command is "Size NoiseMode Octaves"
+void FTerrainBenchmarkTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	TArray<UTerrainBenchmarkCommandlet::FCase> Cases;
+	UTerrainBenchmarkCommandlet::GetCases(UTerrainBenchmarkCommandlet::GetDefaultSizes(), UTerrainBenchmarkCommandlet::GetDefaultOctaves(), Cases);
+
+	for (const UTerrainBenchmarkCommandlet::FCase& Case : Cases)
+	{
+		OutBeautifiedNames.Add(FString::Printf(TEXT("%d.%s.x%d"), Case.Size, *Case.NoiseMode, Case.Octaves));
+		OutTestCommands.Add(FString::Printf(TEXT("%d %s %d"), Case.Size, *Case.NoiseMode, Case.Octaves));
+	}
+}
+
+// Runs the case exactly as the commandlet does and reports every phase's measurements as telemetry
+bool FTerrainBenchmarkTest::RunTest(const FString& Parameters)
+{
+	TArray<FString> Parts;
+	Parameters.ParseIntoArrayWS(Parts);
+	if (Parts.Num() != 3)
+	{
+		AddError(FString::Printf(TEXT("Malformed benchmark case '%s'"), *Parameters));
+		return false;
+	}
+
+	UTerrainBenchmarkCommandlet::FCase Case;
+	Case.Size = FCString::Atoi(*Parts[0]);
+	Case.NoiseMode = Parts[1];
+	Case.Octaves = FCString::Atoi(*Parts[2]);
+
+	UWorld* World = UTerrainBenchmarkCommandlet::CreateBenchmarkWorld();
+	TArray<UTerrainBenchmarkCommandlet::FResult> Results;
+	UTerrainBenchmarkCommandlet::RunCase(World, Case, UTerrainBenchmarkCommandlet::FOptions(), Results);
+	UTerrainBenchmarkCommandlet::DestroyBenchmarkWorld(World);
+
+	if (Results.Num() == 0)
+	{
+		AddError(FString::Printf(TEXT("Benchmark case '%s' produced no results"), *Parameters));
+		return false;
+	}
+
+	for (const UTerrainBenchmarkCommandlet::FResult& Result : Results)
+	{
+		AddTelemetryData(Result.Phase + TEXT(".WallMs"), Result.WallMs, Parameters);
+		AddTelemetryData(Result.Phase + TEXT(".UsedPhysicalDeltaMB"), Result.UsedPhysicalDeltaMB, Parameters);
+		AddTelemetryData(Result.Phase + TEXT(".TerrainDeltaMB"), Result.TerrainDeltaMB, Parameters);
+		AddTelemetryData(Result.Phase + TEXT(".Allocations"), double(Result.Allocations), Parameters);
+		AddTelemetryData(Result.Phase + TEXT(".UploadedVertices"), double(Result.UploadedVertices), Parameters);
+
+		AddInfo(FString::Printf(TEXT("%s: %.3f ms, %+.3f MB used physical, %+.3f MB terrain, %lld allocations, %lld vertices uploaded"),
+			*Result.Phase, Result.WallMs, Result.UsedPhysicalDeltaMB, Result.TerrainDeltaMB, Result.Allocations, Result.UploadedVertices));
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
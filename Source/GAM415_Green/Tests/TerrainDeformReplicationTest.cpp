@@ -0,0 +1,270 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/AutomationTest.h"
+#include "PerlinProcTerrain.h"
+#include "TerrainBenchmarkCommandlet.h"
+#include "Engine/World.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace TerrainDeformReplicationTest
+{
+	// Sends an event through its net serializer, as it would cross the wire
+	static bool RoundTrip(const FTerrainDeformEvent& Event, FTerrainDeformEvent& OutEvent, int64* OutNumBits = nullptr)
+	{
+		FTerrainDeformEvent Sent = Event;
+		bool bWritten = false;
+		FBitWriter Writer(0, true);
+		Sent.NetSerialize(Writer, nullptr, bWritten);
+
+		bool bRead = false;
+		FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+		OutEvent.NetSerialize(Reader, nullptr, bRead);
+
+		if (OutNumBits)
+		{
+			*OutNumBits = Writer.GetNumBits();
+		}
+		return bWritten && bRead && !Writer.IsError() && !Reader.IsError();
+	}
+
+	static TArray<FTerrainDeformEvent> RoundTrip(TConstArrayView<FTerrainDeformEvent> Events)
+	{
+		TArray<FTerrainDeformEvent> Received;
+		for (const FTerrainDeformEvent& Event : Events)
+		{
+			RoundTrip(Event, Received.AddDefaulted_GetRef());
+		}
+		return Received;
+	}
+
+	// Same settings on both machines, as every client generates the terrain itself
+	static APerlinProcTerrain* SpawnTerrain(UWorld* World)
+	{
+		APerlinProcTerrain* Terrain = World->SpawnActor<APerlinProcTerrain>();
+		Terrain->XSize = 64;
+		Terrain->YSize = 64;
+		Terrain->Scale = 100.f;
+		Terrain->UVScale = 1.f / 16.f;
+		Terrain->ZMultiplier = 1000.f;
+		Terrain->NoiseScale = 0.1f;
+		Terrain->bAsyncBuild = false;
+		Terrain->bUseHeightCache = false;
+		Terrain->UploadBudgetMs = 0.f;
+		Terrain->radius = 400.f;
+		Terrain->Depth = FVector(0.0, 0.0, 50.0);
+		Terrain->RadiusClasses = { 200.f, 400.f, 800.f };
+		Terrain->Regenerate();
+		return Terrain;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTerrainDeformEventSerializeTest, "GAM415_Green.Terrain.Deformation.EventSerialize",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+// The packed sequence number, the whole-unit impact point and every 4-bit radius class survive the wire
+bool FTerrainDeformEventSerializeTest::RunTest(const FString& Parameters)
+{
+	using namespace TerrainDeformReplicationTest;
+
+	const uint32 Sequences[] = { 1, 127, 128, 70000, MAX_uint32 };
+	for (const uint32 Sequence : Sequences)
+	{
+		FTerrainDeformEvent Event;
+		Event.Sequence = Sequence;
+
+		FTerrainDeformEvent Received;
+		TestTrue(FString::Printf(TEXT("Sequence %u serializes"), Sequence), RoundTrip(Event, Received));
+		TestEqual(TEXT("Sequence survives"), Received.Sequence, Sequence);
+	}
+
+	for (uint8 RadiusClass = 0; RadiusClass < 16; RadiusClass++)
+	{
+		FTerrainDeformEvent Event;
+		Event.Sequence = 1;
+		Event.RadiusClass = RadiusClass;
+
+		FTerrainDeformEvent Received;
+		TestTrue(FString::Printf(TEXT("Radius class %d serializes"), RadiusClass), RoundTrip(Event, Received));
+		TestEqual(TEXT("Radius class survives"), Received.RadiusClass, RadiusClass);
+	}
+
+	// Positions arrive rounded to whole units; the server rounds before queuing so both sides agree
+	const FVector Centers[] = { FVector(0.0), FVector(6399.6, 12.2, -803.7), FVector(-250.4, 3200.0, 41.9) };
+	for (const FVector& Center : Centers)
+	{
+		FTerrainDeformEvent Event;
+		Event.Sequence = 42;
+		Event.LocalCenter = Center;
+		Event.RadiusClass = 2;
+
+		FTerrainDeformEvent Received;
+		int64 NumBits = 0;
+		TestTrue(TEXT("Event serializes"), RoundTrip(Event, Received, &NumBits));
+		TestEqual(TEXT("Impact point arrives rounded to whole units"), FVector(Received.LocalCenter), Center.RoundToVector());
+		TestTrue(FString::Printf(TEXT("Event packs into 12 bytes or fewer (%lld bits)"), NumBits), NumBits <= 96);
+
+		FTerrainDeformEvent Rounded = Event;
+		Rounded.LocalCenter = Center.RoundToVector();
+		FTerrainDeformEvent ReceivedRounded;
+		RoundTrip(Rounded, ReceivedRounded);
+		TestEqual(TEXT("A rounded impact point arrives unchanged"), FVector(ReceivedRounded.LocalCenter), FVector(Rounded.LocalCenter));
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTerrainDeformEventOrderTest, "GAM415_Green.Terrain.Deformation.EventOrder",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+// Duplicated and reordered events come out once each, in sequence order
+bool FTerrainDeformEventOrderTest::RunTest(const FString& Parameters)
+{
+	FTerrainDeformEventOrder Order;
+	TArray<FTerrainDeformEvent> Ready;
+
+	auto Receive = [&Order, &Ready](uint32 Sequence)
+	{
+		FTerrainDeformEvent Event;
+		Event.Sequence = Sequence;
+		return Order.Receive(Event, Ready);
+	};
+
+	TestTrue(TEXT("First event is accepted"), Receive(1));
+	TestTrue(TEXT("Event past a gap is accepted"), Receive(3));
+	TestEqual(TEXT("Event past a gap is held"), Ready.Num(), 1);
+	TestFalse(TEXT("Held event is not accepted twice"), Receive(3));
+	TestTrue(TEXT("Event filling the gap is accepted"), Receive(2));
+	TestFalse(TEXT("Released event is not accepted twice"), Receive(2));
+	TestTrue(TEXT("Later event is accepted"), Receive(5));
+	TestTrue(TEXT("Earlier event is accepted after a later one"), Receive(4));
+
+	TestEqual(TEXT("Every event is released"), Ready.Num(), 5);
+	for (int32 i = 0; i < Ready.Num(); i++)
+	{
+		TestEqual(FString::Printf(TEXT("Release %d is in sequence order"), i), Ready[i].Sequence, uint32(i + 1));
+	}
+	TestEqual(TEXT("Nothing is left held"), Order.Held.Num(), 0);
+
+	// Skipping past held events drops the ones the skip covers and releases the rest in order
+	Ready.Reset();
+	Receive(7);
+	Receive(9);
+	Receive(10);
+	Order.SkipTo(8, Ready);
+	TestEqual(TEXT("Skip releases the held events that follow it"), Ready.Num(), 2);
+	TestEqual(TEXT("Skip drops the held events it covers"), Order.Held.Num(), 0);
+	TestEqual(TEXT("Skip leaves the newest released event last"), Order.LastSequence, uint32(10));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTerrainDeformLateJoinTest, "GAM415_Green.Terrain.Deformation.LateJoin",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+// A server terrain takes impacts through QueueDeformation. A client terrain joins part way: it gets
+// the snapshot through OnRep_DeformSnapshot, then the multicasts still in flight, repeating part of
+// the tail and arriving out of order. Both drain through the batched deformation path and must end
+// with the same heights.
+bool FTerrainDeformLateJoinTest::RunTest(const FString& Parameters)
+{
+	using namespace TerrainDeformReplicationTest;
+
+	UWorld* World = UTerrainBenchmarkCommandlet::CreateBenchmarkWorld();
+	APerlinProcTerrain* Server = SpawnTerrain(World);
+	APerlinProcTerrain* Client = SpawnTerrain(World);
+
+	// The transient world has no net driver: record events as a listen server would, and make the
+	// client a proxy so it takes the client side of every authority check
+	Server->bRecordDeformEventsStandalone = true;
+	Client->SetRole(ROLE_SimulatedProxy);
+
+	auto DrainAll = [](APerlinProcTerrain* Terrain)
+	{
+		while (Terrain->GetNumQueuedDeformations() > 0 && Terrain->DrainDeformations(1000.0) > 0)
+		{
+		}
+	};
+
+	// Overlapping and separate craters, so the server merges some into batches
+	auto Fire = [Server](int32 Index)
+	{
+		const double Extent = Server->XSize * Server->Scale;
+		const FVector2D Point(Extent * (0.2 + 0.06 * (Index % 10)), Extent * (0.3 + 0.05 * (Index / 3)));
+		float SurfaceZ = 0.f;
+		Server->GetHeightBilinear(Point, SurfaceZ);
+		Server->QueueDeformation(Server->GetActorLocation() + FVector(Point.X, Point.Y, SurfaceZ));
+	};
+
+	// Six impacts, applied and captured into the snapshot's journal
+	for (int32 i = 0; i < 6; i++)
+	{
+		Fire(i);
+	}
+	DrainAll(Server);
+	Server->CaptureDeformSnapshot();
+	Server->OutgoingDeformEvents.Reset();
+
+	// Three more go into the snapshot's tail and the first multicast; three after that into the second
+	for (int32 i = 6; i < 9; i++)
+	{
+		Fire(i);
+	}
+	const TArray<FTerrainDeformEvent> FirstMulticast = Server->OutgoingDeformEvents;
+	Server->OutgoingDeformEvents.Reset();
+	const FTerrainDeformSnapshot Snapshot = Server->DeformSnapshot;
+
+	for (int32 i = 9; i < 12; i++)
+	{
+		Fire(i);
+	}
+	TArray<FTerrainDeformEvent> SecondMulticast = Server->OutgoingDeformEvents;
+	Server->OutgoingDeformEvents.Reset();
+	DrainAll(Server);
+
+	TestEqual(TEXT("Server assigned every sequence number"), Server->GetLastDeformSequence(), int64(12));
+	TestEqual(TEXT("Snapshot journal covers the first six impacts"), Snapshot.Sequence, uint32(6));
+	TestEqual(TEXT("Snapshot tail holds the three after it"), Snapshot.Tail.Num(), 3);
+
+	// Late join: the snapshot arrives with the actor, then both multicasts, the second one reordered
+	Client->DeformSnapshot = Snapshot;
+	Client->DeformSnapshot.Tail = RoundTrip(Snapshot.Tail);
+	Client->OnRep_DeformSnapshot();
+
+	Client->MulticastDeformEvents_Implementation(RoundTrip(FirstMulticast));
+	if (SecondMulticast.Num() == 3)
+	{
+		Swap(SecondMulticast[0], SecondMulticast[2]);
+	}
+	Client->MulticastDeformEvents_Implementation(RoundTrip(SecondMulticast));
+	DrainAll(Client);
+
+	TestEqual(TEXT("Client queued every event once"), Client->GetLastDeformSequence(), int64(12));
+	TestEqual(TEXT("Client holds no events back"), Client->DeformEventOrder.Held.Num(), 0);
+	TestEqual(TEXT("Client deformed the same vertices"), Client->GetNumJournaledVertices(), Server->GetNumJournaledVertices());
+	TestTrue(TEXT("Server deformed the terrain"), Server->GetNumJournaledVertices() > 0);
+
+	// The journal replays net deltas rather than each crater in turn, so allow float rounding
+	const FTerrainHeights& ServerHeights = Server->Grid.Heights;
+	const FTerrainHeights& ClientHeights = Client->Grid.Heights;
+	if (TestEqual(TEXT("Both terrains have the same grid"), ClientHeights.Num(), ServerHeights.Num()))
+	{
+		for (int32 Index = 0; Index < ServerHeights.Num(); Index++)
+		{
+			if (!FMath::IsNearlyEqual(ServerHeights.Get(Index), ClientHeights.Get(Index), 1e-2f))
+			{
+				AddError(FString::Printf(TEXT("Vertex %d: server height %f, late joiner %f"), Index, ServerHeights.Get(Index), ClientHeights.Get(Index)));
+				break;
+			}
+		}
+	}
+
+	Server->Destroy();
+	Client->Destroy();
+	UTerrainBenchmarkCommandlet::DestroyBenchmarkWorld(World);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
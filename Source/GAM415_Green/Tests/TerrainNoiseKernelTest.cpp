@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/AutomationTest.h"
+#include "TerrainNoise.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTerrainNoiseKernelTest, "GAM415_Green.Terrain.Noise.RowKernels",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+// Every row kernel specialization (basis x fold mode x octave count) must match the scalar Fractal2D
+// reference. Octave counts 1 to 8 each have an unrolled kernel; 0 is the zero kernel and 9 and 11 take
+// the run-time count kernel. Rows are an odd length so the SIMD tail is covered, and run both along
+// a grid row and diagonally.
+bool FTerrainNoiseKernelTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 Count = 259;
+	constexpr float Tolerance = 1e-4f;
+	const int32 OctaveCounts[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 11 };
+	const FVector2f Steps[] = { FVector2f(0.f, 100.f), FVector2f(37.5f, 61.f) };
+	const TCHAR* FoldNames[] = { TEXT("None"), TEXT("Ridge"), TEXT("Billow") };
+
+	float Row[Count];
+	float MaxError = 0.f;
+
+	for (int32 Type = 0; Type < 3; Type++)
+	{
+		for (int32 Fold = 0; Fold < 3; Fold++)
+		{
+			for (const int32 Octaves : OctaveCounts)
+			{
+				FTerrainNoiseSettings Settings;
+				Settings.Seed = 1337 + Fold;
+				Settings.Type = ETerrainNoiseType(Type);
+				Settings.Octaves = Octaves;
+				Settings.Frequency = 0.0035f;
+				Settings.bRidge = Fold == 1;
+				Settings.bBillow = Fold == 2;
+
+				const FTerrainNoiseTable& Table = *TerrainNoise::GetTable(Settings.Seed);
+				const TerrainNoise::FRowKernel Kernel = TerrainNoise::GetRowKernel(Settings);
+				const FVector2f Start(-517.f, 1234.5f);
+
+				for (const FVector2f& Step : Steps)
+				{
+					Kernel(Table, Settings, Start, Step, Count, Row);
+
+					float CaseError = 0.f;
+					int32 WorstSample = 0;
+					for (int32 i = 0; i < Count; i++)
+					{
+						const float Expected = TerrainNoise::Fractal2D(Table, Settings, Start.X + float(i) * Step.X, Start.Y + float(i) * Step.Y);
+						const float Error = FMath::Abs(Row[i] - Expected);
+						if (Error > CaseError)
+						{
+							CaseError = Error;
+							WorstSample = i;
+						}
+					}
+
+					if (CaseError > Tolerance)
+					{
+						AddError(FString::Printf(TEXT("Basis %d, fold %s, %d octaves, step (%g, %g): sample %d is off by %g"),
+							Type, FoldNames[Fold], Octaves, Step.X, Step.Y, WorstSample, CaseError));
+					}
+					MaxError = FMath::Max(MaxError, CaseError);
+				}
+			}
+		}
+	}
+
+	AddInfo(FString::Printf(TEXT("Largest difference from the scalar reference: %g"), MaxError));
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS